@@ -1,13 +1,36 @@
 #pragma once
 
 #include "json.hpp"
+#include "engine/comparisonkernel.h"
+#include "engine/comparisonfilter.h"
+#include "engine/countstage.h"
+#include "engine/formscan.h"
+#include "engine/statictable.h"
+#include "engine/filtervm.h"
+#include "engine/filterjit.h"
+#include "engine/settings.h"
+#include "engine/pricetable.h"
+#include "engine/scheduler.h"
+#include "engine/threadpool.h"
+#include "engine/telemetry.h"
+#include "engine/trace.h"
+#include "engine/ruleprofiler.h"
+#include "engine/capture.h"
+#include "engine/formdump.h"
 #include <string>
 #include <vector>
 #include <map>
 #include <random>
 #include <fstream>
 #include <algorithm>
+#include <numeric>
 #include <unordered_map>
+#include <unordered_set>
+#include <optional>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <memory>
 #include <boost/algorithm/string.hpp>
 
 struct LocalForm {
@@ -72,85 +95,6 @@ struct ValueRange {
 	}
 };
 
-// Structure for comparison operations (>, <, =, >=, <=)
-struct ComparisonFilter {
-	enum ComparisonType { NONE, GREATER, LESS, EQUAL, GREATER_EQUAL, LESS_EQUAL };
-	ComparisonType type;
-	float value;
-
-	ComparisonFilter() : type(NONE), value(0.0f) {}
-	
-	ComparisonFilter(const std::string& filterStr) {
-		ParseFilter(filterStr);
-	}
-
-	void ParseFilter(const std::string& filterStr) {
-		logger::trace("Parsing comparison filter: '{}'", filterStr);
-		if (filterStr == "NONE" || filterStr.empty()) {
-			type = NONE;
-			logger::debug("Comparison filter set to NONE");
-			return;
-		}
-
-		if (filterStr.find(">=") != std::string::npos) {
-			type = GREATER_EQUAL;
-			value = std::stof(filterStr.substr(2));
-			logger::debug("Parsed GREATER_EQUAL filter with value: {}", value);
-		} else if (filterStr.find("<=") != std::string::npos) {
-			type = LESS_EQUAL;
-			value = std::stof(filterStr.substr(2));
-			logger::debug("Parsed LESS_EQUAL filter with value: {}", value);
-		} else if (filterStr.find(">") != std::string::npos) {
-			type = GREATER;
-			value = std::stof(filterStr.substr(1));
-			logger::debug("Parsed GREATER filter with value: {}", value);
-		} else if (filterStr.find("<") != std::string::npos) {
-			type = LESS;
-			value = std::stof(filterStr.substr(1));
-			logger::debug("Parsed LESS filter with value: {}", value);
-		} else if (filterStr.find("=") != std::string::npos) {
-			type = EQUAL;
-			value = std::stof(filterStr.substr(1));
-			logger::debug("Parsed EQUAL filter with value: {}", value);
-		} else {
-			type = NONE;
-			logger::debug("Could not parse comparison filter, set to NONE");
-		}
-	}
-
-	bool Matches(float testValue) const {
-		bool result;
-		switch (type) {
-			case GREATER: 
-				result = testValue > value;
-				logger::trace("Comparison {} > {}: {}", testValue, value, result);
-				return result;
-			case LESS: 
-				result = testValue < value;
-				logger::trace("Comparison {} < {}: {}", testValue, value, result);
-				return result;
-			case EQUAL: 
-				result = testValue == value;
-				logger::trace("Comparison {} == {}: {}", testValue, value, result);
-				return result;
-			case GREATER_EQUAL: 
-				result = testValue >= value;
-				logger::trace("Comparison {} >= {}: {}", testValue, value, result);
-				return result;
-			case LESS_EQUAL: 
-				result = testValue <= value;
-				logger::trace("Comparison {} <= {}: {}", testValue, value, result);
-				return result;
-			case NONE: 
-				logger::trace("Comparison filter is NONE, returning true");
-				return true;
-			default: 
-				logger::trace("Unknown comparison type, returning true");
-				return true;
-		}
-	}
-};
-
 // Structure for globals' expression
 struct GlobalsFilter {
 	std::string globalEditorID;
@@ -384,7 +328,10 @@ struct ConfigEntry {
 	ValueRange value;
 	int low_cap;
 	int high_cap;
+	CountStage::Rounding rounding = CountStage::Rounding::Truncate;
 	FilterSet filters;
+	std::string source;  // config file the entry was loaded from
+	size_t index = 0;    // position within its section of that file
 
 	ConfigEntry() = default;
 	
@@ -409,6 +356,11 @@ struct ConfigEntry {
 			}
 			else value.ParseValue(val.get<std::string>());
 		}
+
+		if (entryJson.contains("rounding")) {
+			rounding = CountStage::ParseRounding(entryJson["rounding"].get<std::string>());
+			logger::debug("Parsed count rounding mode: {}", static_cast<int>(rounding));
+		}
 		
 		if (entryJson.contains("filters")) {
 			filters.ParseFilters(entryJson["filters"]);
@@ -416,6 +368,10 @@ struct ConfigEntry {
 		logger::debug("Created config entry with value range [{}, {}] and filter set", 
 					value.min, value.max);
 	}
+
+	std::string Origin() const {
+		return std::format("{} #{}", source, index + 1);
+	}
 };
 
 class ConfigManager : public SINGLETON<ConfigManager> {
@@ -427,26 +383,49 @@ public:
 
 	// Get buy price multiplier for given conditions
 	float GetBuyPriceMultiplier(RE::Actor* trader = nullptr, RE::InventoryEntryData* item = nullptr, RE::PlayerCharacter* player = nullptr) {
+		Telemetry::Timer timer(Telemetry::Probe::BuyPrice);
 		logger::trace("Getting buy price multiplier for trader: {}, item: {}, player: {}", 
 					(void*)trader, (void*)item, (void*)player);
 
+		if (!replayingRolls) rolls.clear();
 		if(trader_id != trader->formID){
 			trader_id = trader->formID;
 			buyPrice_cache.clear();
+			ResetSessionMemo();
+		}
+
+		if (auto price = FindPrice(buyTable, trader, item)) {
+			float multiplier = price->fixed;
+			price->ranged.ForEach([&](size_t i) { multiplier *= RolledValue(buyPrice_cache, buyPriceEntries[i], i, item->object); });
+			logger::trace("Buy price multiplier {} served from the precomputed table", multiplier);
+			return multiplier;
 		}
 
 		float multiplier = 1.0f;
 
-		for (size_t i = 0; i < buyPriceEntries.size(); ++i) {
+		// Fully static entries are folded per form, only the dynamic ones are evaluated here
+		const std::vector<size_t>* entries = &buyKernel.allEntries;
+		if (auto folded = LookupStatic(buyKernel, item)) {
+			multiplier = *folded;
+			entries = &buyKernel.dynamicEntries;
+			logger::trace("Folded static buy price multiplier {}", multiplier);
+			if (entries->empty()) return multiplier;
+		}
+
+		gameState.Reset();
+		RuleMask rowMask, matched;
+		EvaluateItemRows(buyKernel, item, rowMask);
+		FilterVM::Context ctx{ item, trader, player, &rowMask, MemoFor(trader), &gameState };
+		MatchEntries(buyKernel, ctx, *entries, matched);
+		SuppressFolded(buyKernel, matched);
+		Telemetry::getInstance()->RecordRules(0, *entries, matched);
+
+		for (size_t i : *entries) {
 			const auto& entry = buyPriceEntries[i];
-			std::pair<int, RE::FormID> rulePair(i, item->object->formID);
 			
 			logger::trace("Checking buy price entry {} of {}", i + 1, buyPriceEntries.size());
-			if (MatchesFilters(entry.filters, trader, item, player)) {
-				float mult = entry.value.GetValue();
-
-				if (buyPrice_cache.contains(rulePair)) mult = buyPrice_cache[rulePair];
-				else buyPrice_cache[rulePair] = mult;
+			if (matched.Test(i)) {
+				float mult = RolledValue(buyPrice_cache, entry, i, item->object);
 
 				logger::info("Buy price multiplier {} applied from entry {}", mult, i + 1);
 				multiplier *= mult;
@@ -459,26 +438,49 @@ public:
 
 	// Get sell price multiplier for given conditions
 	float GetSellPriceMultiplier(RE::Actor* trader = nullptr, RE::InventoryEntryData* item = nullptr, RE::PlayerCharacter* player = nullptr) {
+		Telemetry::Timer timer(Telemetry::Probe::SellPrice);
 		logger::trace("Getting sell price multiplier for trader: {}, item: {}, player: {}", 
 					(void*)trader, (void*)item, (void*)player);
 
+		if (!replayingRolls) rolls.clear();
 		if(trader_id != trader->formID){
 			trader_id = trader->formID;
 			sellPrice_cache.clear();
+			ResetSessionMemo();
+		}
+
+		if (auto price = FindPrice(sellTable, trader, item)) {
+			float multiplier = price->fixed;
+			price->ranged.ForEach([&](size_t i) { multiplier *= RolledValue(sellPrice_cache, sellPriceEntries[i], i, item->object); });
+			logger::trace("Sell price multiplier {} served from the precomputed table", multiplier);
+			return multiplier;
 		}
 
 		float multiplier = 1.0f;
 
-		for (size_t i = 0; i < sellPriceEntries.size(); ++i) {
+		// Fully static entries are folded per form, only the dynamic ones are evaluated here
+		const std::vector<size_t>* entries = &sellKernel.allEntries;
+		if (auto folded = LookupStatic(sellKernel, item)) {
+			multiplier = *folded;
+			entries = &sellKernel.dynamicEntries;
+			logger::trace("Folded static sell price multiplier {}", multiplier);
+			if (entries->empty()) return multiplier;
+		}
+
+		gameState.Reset();
+		RuleMask rowMask, matched;
+		EvaluateItemRows(sellKernel, item, rowMask);
+		FilterVM::Context ctx{ item, trader, player, &rowMask, MemoFor(trader), &gameState };
+		MatchEntries(sellKernel, ctx, *entries, matched);
+		SuppressFolded(sellKernel, matched);
+		Telemetry::getInstance()->RecordRules(1, *entries, matched);
+
+		for (size_t i : *entries) {
 			const auto& entry = sellPriceEntries[i];
-			std::pair<int, RE::FormID> rulePair(i, item->object->formID);
 
 			logger::trace("Checking sell price entry {} of {}", i + 1, sellPriceEntries.size());
-			if (MatchesFilters(entry.filters, trader, item, player)) {
-				float mult = entry.value.GetValue();
-
-				if (sellPrice_cache.contains(rulePair)) mult = sellPrice_cache[rulePair];
-				else sellPrice_cache[rulePair] = mult;
+			if (matched.Test(i)) {
+				float mult = RolledValue(sellPrice_cache, entry, i, item->object);
 
 				logger::info("Sell price multiplier {} applied from entry {}", mult, i + 1);
 				multiplier *= mult;
@@ -489,117 +491,1753 @@ public:
 		return multiplier; // Default multiplier
 	}
 
-	// Get count multiplier for given conditions
-	float GetCountMultiplier(RE::Actor* trader = nullptr, RE::InventoryEntryData* item = nullptr, RE::PlayerCharacter* player = nullptr) {
-		logger::trace("Getting count multiplier for trader: {}, item: {}, player: {}", 
-					(void*)trader, (void*)item, (void*)player);
-		
-		float multiplier = 1.0f;
+	// Applies count multipliers to every entry of a restocked inventory in one pass.
+	// Merchant and player sections are evaluated once per rule, item sections as an items x rules matrix.
+	void ApplyCountMultipliers(RE::Actor* trader, RE::InventoryChanges* inv, RE::PlayerCharacter* player) {
+		if (!inv || !inv->entryList) return;
+
+		std::vector<RE::InventoryEntryData*> items;
+		for (auto&& entry : *inv->entryList) {
+			if (entry && entry->object) items.push_back(entry);
+		}
+
+		if (!capture.IsOpen() || !trader) {
+			RestockItems(trader, items, player);
+			return;
+		}
+		Capture::Restock record{ .state = CaptureState(trader, player), .owner = inv->owner ? inv->owner->GetFormID() : 0 };
+		for (auto item : items) {
+			record.items.push_back({ item->object->GetFormID(), item->countDelta, ValueCache::getInstance()->Get(item), item->object->GetWeight(), 0 });
+		}
+		rolls.clear();
+		RestockItems(trader, items, player);
+		for (size_t n = 0; n < items.size(); ++n) record.items[n].result = items[n]->countDelta;
+		record.rolls = rolls;
+		capture.Write(record);
+	}
+
+	// Count multipliers over the stacks of one restock, rewriting their countDelta
+	void RestockItems(RE::Actor* trader, const std::vector<RE::InventoryEntryData*>& items, RE::PlayerCharacter* player) {
+		Telemetry::Timer timer(Telemetry::Probe::RestockItems);
+		Trace::Span span("ApplyCountMultipliers", "restock", static_cast<std::uint32_t>(items.size()));
+
+		ResetSessionMemo();
+		gameState.Reset();
+		RuleMask eligible(countEntries.size());
+		FilterVM::Context actors{ nullptr, trader, player, nullptr, MemoFor(trader), &gameState };
+		const auto& possible = TraderVerdicts(countKernel, trader);
+		possible.ForEach([&](size_t i) {
+			if (FilterVM::Run(countKernel.program, countKernel.actorStart[i], actors)) eligible.Set(i);
+		});
+		logger::debug("Restock batch: {} of {} count entries pass merchant/player filters", eligible.Count(), countEntries.size());
+		if (items.empty() || !eligible.Any()) return;
+
+		// Column buffer of the item attributes the kernel reads
+		const auto& kernel = countKernel.kernel;
+		std::vector<float> weights(items.size());
+		std::vector<float> values(items.size(), 0.0f);
+		for (size_t n = 0; n < items.size(); ++n) {
+			weights[n] = items[n]->object->GetWeight();
+			if (kernel.HasValueColumn()) values[n] = static_cast<float>(ValueCache::getInstance()->Get(items[n]));
+		}
+
+		std::vector<RuleMask> matrix(items.size());
+		RuleMask rowMask;
+		for (size_t n = 0; n < items.size(); ++n) {
+			kernel.Evaluate(weights[n], values[n], rowMask);
+			ApplyStaticRows(countKernel, items[n]->object, rowMask);
+
+			auto& matches = matrix[n];
+			matches.Resize(countEntries.size());
+			eligible.ForEach([&](size_t i) {
+				if (rowMask.Contains(countKernel.ruleRows[i])) matches.Set(i);
+			});
+			SuppressFolded(countKernel, matches);
+			Telemetry::getInstance()->RecordRules(2, countKernel.allEntries, matches);
+		}
 
-		for (size_t i = 0; i < countEntries.size(); ++i) {
-			const auto& entry = countEntries[i];
-			logger::trace("Checking count entry {} of {}", i + 1, countEntries.size());
-			if (MatchesFilters(entry.filters, trader, item, player)) {
-				float mult = entry.value.GetValue();
-				logger::info("Count multiplier {} applied from entry {}", mult, i + 1);
+		// Matching rules combine by multiplying values, taking the tightest caps and the first rule's rounding mode
+		CountStage stage;
+		std::vector<size_t> lanes(items.size(), SIZE_MAX);
+		for (size_t n = 0; n < items.size(); ++n) {
+			if (!matrix[n].Any()) continue;
+
+			float multiplier = 1.0f;
+			std::int32_t low = CountStage::kNoCap;
+			std::int32_t high = CountStage::kNoCap;
+			std::optional<CountStage::Rounding> rounding;
+			matrix[n].ForEach([&](size_t i) {
+				const auto& entry = countEntries[i];
+				float mult = Roll(static_cast<std::uint32_t>(n), i, entry);
+				logger::info("Count multiplier {} applied to {} from entry {}", mult, items[n]->GetDisplayName(), i + 1);
 				multiplier *= mult;
-			}
+				if (entry.low_cap != CountStage::kNoCap) low = low == CountStage::kNoCap ? entry.low_cap : std::max(low, entry.low_cap);
+				if (entry.high_cap != CountStage::kNoCap) high = high == CountStage::kNoCap ? entry.high_cap : std::min(high, entry.high_cap);
+				if (!rounding) rounding = entry.rounding;
+			});
+			lanes[n] = stage.Push(items[n]->countDelta, multiplier, low, high, *rounding);
 		}
-		logger::debug("No count entries matched, returning default multiplier 1.0");
-		return multiplier; // Default multiplier
+
+		stage.Run();
+		for (size_t n = 0; n < items.size(); ++n) {
+			if (lanes[n] == SIZE_MAX) continue;
+			logger::debug("Restocked {}: {} -> {}", items[n]->GetDisplayName(), items[n]->countDelta, stage.Result(lanes[n]));
+			items[n]->countDelta = stage.Result(lanes[n]);
+		}
+		logger::debug("Restock batch applied to {} of {} items", stage.Size(), items.size());
+		Telemetry::getInstance()->Count(Telemetry::Event::RestockedStack, stage.Size());
 	}
 
 	// Reload configuration from file
 	bool ReloadConfig() {
 		logger::info("Reloading configuration from: {}", configPath);
+		StopPriceTables();
 		buyPriceEntries.clear();
 		sellPriceEntries.clear();
 		countEntries.clear();
+		settings = {};
 		return LoadConfig(configPath);
 	}
 
+	const EngineSettings& Settings() const { return settings; }
+
+	// Recompiles every section so predicates run in the order learned so far
+	void Reoptimize() {
+		CompileAndJIT(buyKernel, buyPriceEntries, "BuyPrices");
+		CompileAndJIT(sellKernel, sellPriceEntries, "SellPrices");
+		CompileAndJIT(countKernel, countEntries, "Counts");
+		ReportDedupe();
+		logger::info("Reordered predicates using statistics for {} predicates", predicateStats.Size());
+	}
+
+	// Shared merchant/player predicate results only hold while the merchant and the player's state are unchanged
+	void ResetSessionMemo() {
+		sessionMemo.assign(predicateStats.Size(), FilterVM::kUnknown);
+	}
+
+	// The memo for calls about `trader`: results computed for another actor (a restock of another
+	// vendor, a deferred restock) are dropped before they can answer for this one
+	std::uint8_t* MemoFor(RE::Actor* trader) {
+		const RE::FormID id = trader ? trader->GetFormID() : 0;
+		if (id != memoTrader || sessionMemo.size() != predicateStats.Size()) {
+			memoTrader = id;
+			ResetSessionMemo();
+		}
+		return sessionMemo.data();
+	}
+
+	void BeginSession(RE::Actor* trader) {
+		Trace::Span span("BeginSession", "session");
+		logger::debug("Barter session started");
+		RelationshipCache::getInstance()->Invalidate(trader);
+		ResetSessionMemo();
+		gameState.ResetCounters();
+		servedFromTable = 0;
+		servedInline = 0;
+		if (trader && settings.backgroundPrices) StartPriceTables(trader, RE::PlayerCharacter::GetSingleton());
+	}
+
+	void EndSession() {
+		StopPriceTables();
+		logger::info("Barter session ended: {} prices served from precomputed tables, {} evaluated inline",
+			servedFromTable, servedInline);
+		logger::info("Barter session ended: {} game state reads, {} engine calls, {} saved by the per-call snapshot",
+			gameState.Reads(), gameState.Calls(), gameState.Reads() - gameState.Calls());
+		ResetSessionMemo();
+		ReportPool("Barter session");
+	}
+
+	// Workers of the shared pool, created on first use
+	ThreadPool& Pool() {
+		if (!pool) pool = std::make_unique<ThreadPool>(settings.workerThreads);
+		return *pool;
+	}
+
+	// Applies WorkerThreads; only called between loads, when no task is queued
+	void ResizePool() {
+		const size_t threads = ThreadPool::ClampThreads(settings.workerThreads);
+		if (pool && pool->Threads() == threads) return;
+		pool = std::make_unique<ThreadPool>(threads);
+		logger::info("Worker pool: {} threads on {} cores", threads, std::thread::hardware_concurrency());
+	}
+
+	// Per-worker share of time spent running tasks since the last report
+	void ReportPool(const char* phase) {
+		if (!pool) return;
+		std::string utilization;
+		std::uint64_t executed = 0, stolen = 0;
+		const auto busy = pool->Utilization();
+		for (size_t i = 0; i < busy.size(); ++i) {
+			utilization += std::format("{}{:.0f}%", i ? " " : "", busy[i]);
+			executed += pool->Stats(i).executed;
+			stolen += pool->Stats(i).stolen;
+		}
+		if (executed) logger::info("{}: worker pool ran {} tasks ({} stolen), utilization per worker: {}", phase, executed, stolen, utilization);
+		pool->ResetStats();
+	}
+
+	// Console report of the telemetry window: rule hit rates, cache ratios, latencies and restocks
+	std::vector<std::string> StatsReport(size_t topRules) {
+		std::vector<std::string> lines;
+		if constexpr (!Telemetry::kEnabled) {
+			lines.push_back("Telemetry was compiled out of this build");
+			return lines;
+		}
+		const auto stats = Telemetry::getInstance()->Merge();
+		const std::vector<ConfigEntry>* sections[] = { &buyPriceEntries, &sellPriceEntries, &countEntries };
+
+		for (size_t p = 0; p < Telemetry::kProbes; ++p) {
+			const auto& h = stats.latency[p];
+			lines.push_back(std::format("{}: {} calls, p50 {:.1f} us, p99 {:.1f} us, max {:.1f} us", Telemetry::kProbeNames[p], h.count,
+				h.Percentile(0.5) / 1000.0, h.Percentile(0.99) / 1000.0, h.maxNs / 1000.0));
+		}
+		for (size_t c = 0; c < Telemetry::kCaches; ++c) {
+			const auto& cache = stats.caches[c];
+			lines.push_back(std::format("Cache {}: {} hits, {} misses ({:.1f}% hit)", Telemetry::kCacheNames[c], cache.hits, cache.misses, cache.HitRate()));
+		}
+		lines.push_back(std::format("Restocks: {} inline, {} deferred, {} stacks changed",
+			stats.events[static_cast<size_t>(Telemetry::Event::Restock)], stats.events[static_cast<size_t>(Telemetry::Event::DeferredRestock)],
+			stats.events[static_cast<size_t>(Telemetry::Event::RestockedStack)]));
+
+		for (size_t k = 0; k < 3; ++k) {
+			const auto& rules = stats.rules[k];
+			std::vector<size_t> order(rules.size());
+			std::iota(order.begin(), order.end(), size_t{ 0 });
+			std::ranges::stable_sort(order, std::greater{}, [&](size_t i) { return rules[i].matches; });
+			const auto silent = std::ranges::count_if(rules, [](const auto& rule) { return rule.evaluations && !rule.matches; });
+			lines.push_back(std::format("{}: {} entries, {} evaluated without a single match", kSectionNames[k], rules.size(), silent));
+			for (size_t n = 0; n < order.size() && n < topRules && rules[order[n]].matches; ++n) {
+				const auto& rule = rules[order[n]];
+				lines.push_back(std::format("  {}: {} of {} ({:.1f}%)", (*sections[k])[order[n]].Origin(), rule.matches, rule.evaluations,
+					100.0 * rule.matches / rule.evaluations));
+			}
+		}
+		if (profiler.Enabled()) {
+			lines.push_back(std::format("Sampled costs (1 in {} rules, 1 in {} calls), estimated totals:", profiler.RuleEvery(), profiler.CallEvery()));
+			for (size_t k = 0; k < 3; ++k) {
+				const auto& rules = profiler.Rules(k);
+				std::vector<size_t> order(rules.size());
+				std::iota(order.begin(), order.end(), size_t{ 0 });
+				std::ranges::stable_sort(order, std::greater{}, [&](size_t i) { return rules[i].ticks; });
+				lines.push_back(std::format("  {}: {} calls, {:.2f} ms", kSectionNames[k], profiler.CallStats(k).calls, profiler.EstimatedCallNs(k) / 1e6));
+				for (size_t n = 0; n < order.size() && n < topRules && rules[order[n]].samples; ++n) {
+					const auto& rule = rules[order[n]];
+					lines.push_back(std::format("    {}: {:.2f} ms, {:.0f} ns each{}", (*sections[k])[order[n]].Origin(), profiler.EstimatedNs(rule) / 1e6,
+						profiler.MeanNs(rule), rule.flagged ? " (over budget)" : ""));
+				}
+			}
+		}
+		lines.push_back(std::format("Deferred work: queue depth {} (max {}), {} finished, {} overruns; {} worker threads",
+			Scheduler::getInstance()->Depth(), Scheduler::getInstance()->MaxDepth(), Scheduler::getInstance()->Completed(),
+			Scheduler::getInstance()->Overruns(), pool ? pool->Threads() : 0));
+		return lines;
+	}
+
+	// Full snapshot of the telemetry window as StockControl_Stats.csv (rules) and .json (everything) in `dir`
+	bool WriteStats(const std::filesystem::path& dir) {
+		if constexpr (!Telemetry::kEnabled) return false;
+		const auto stats = Telemetry::getInstance()->Merge();
+		const std::vector<ConfigEntry>* sections[] = { &buyPriceEntries, &sellPriceEntries, &countEntries };
+
+		std::ofstream csv(dir / "StockControl_Stats.csv");
+		if (!csv.is_open()) {
+			logger::error("Failed to write statistics to {}", dir.string());
+			return false;
+		}
+		csv << "section,entry,origin,evaluations,matches,hit_rate\n";
+
+		nlohmann::json statsJson;
+		for (size_t k = 0; k < 3; ++k) {
+			auto& rulesJson = statsJson["rules"][kSectionNames[k]];
+			rulesJson = nlohmann::json::array();
+			for (size_t i = 0; i < stats.rules[k].size(); ++i) {
+				const auto& rule = stats.rules[k][i];
+				const double rate = rule.evaluations ? static_cast<double>(rule.matches) / rule.evaluations : 0.0;
+				const auto origin = (*sections[k])[i].Origin();
+				csv << std::format("{},{},\"{}\",{},{},{:.6f}\n", kSectionNames[k], i, origin, rule.evaluations, rule.matches, rate);
+				rulesJson.push_back({ { "origin", origin }, { "evaluations", rule.evaluations }, { "matches", rule.matches } });
+			}
+		}
+		for (size_t p = 0; p < Telemetry::kProbes; ++p) {
+			const auto& h = stats.latency[p];
+			auto& probeJson = statsJson["latency"][Telemetry::kProbeNames[p]];
+			probeJson = { { "count", h.count }, { "mean_ns", h.MeanNs() }, { "p50_ns", h.Percentile(0.5) }, { "p90_ns", h.Percentile(0.9) },
+				{ "p99_ns", h.Percentile(0.99) }, { "p999_ns", h.Percentile(0.999) }, { "max_ns", h.maxNs } };
+			for (size_t b = 0; b < h.buckets.size(); ++b) {
+				if (h.buckets[b]) probeJson["buckets"].push_back({ LatencyBuckets::Upper(b), h.buckets[b] });
+			}
+		}
+		for (size_t c = 0; c < Telemetry::kCaches; ++c) {
+			statsJson["caches"][Telemetry::kCacheNames[c]] = { { "hits", stats.caches[c].hits }, { "misses", stats.caches[c].misses } };
+		}
+		for (size_t e = 0; e < Telemetry::kEvents; ++e) statsJson["events"][Telemetry::kEventNames[e]] = stats.events[e];
+		statsJson["scheduler"] = { { "depth", Scheduler::getInstance()->Depth() }, { "max_depth", Scheduler::getInstance()->MaxDepth() },
+			{ "completed", Scheduler::getInstance()->Completed() }, { "overruns", Scheduler::getInstance()->Overruns() },
+			{ "worst_overrun_ms", Scheduler::getInstance()->WorstOverrun() } };
+		if (pool) {
+			const auto utilization = pool->Utilization();
+			for (size_t i = 0; i < pool->Threads(); ++i) {
+				statsJson["workers"].push_back({ { "executed", pool->Stats(i).executed.load() }, { "stolen", pool->Stats(i).stolen.load() },
+					{ "utilization", utilization[i] } });
+			}
+		}
+		if (profiler.Enabled()) {
+			auto& profileJson = statsJson["profile"];
+			profileJson["rule_every"] = profiler.RuleEvery();
+			profileJson["call_every"] = profiler.CallEvery();
+			profileJson["budget_ms"] = profiler.BudgetMs();
+			for (size_t k = 0; k < 3; ++k) {
+				auto& sectionJson = profileJson["sections"][kSectionNames[k]];
+				sectionJson["calls"] = profiler.CallStats(k).calls;
+				sectionJson["estimated_ms"] = profiler.EstimatedCallNs(k) / 1e6;
+				sectionJson["rules"] = nlohmann::json::array();
+				for (size_t i = 0; i < profiler.Rules(k).size(); ++i) {
+					const auto& rule = profiler.Rules(k)[i];
+					sectionJson["rules"].push_back({ { "origin", (*sections[k])[i].Origin() }, { "samples", rule.samples },
+						{ "mean_ns", profiler.MeanNs(rule) }, { "estimated_ms", profiler.EstimatedNs(rule) / 1e6 }, { "flagged", rule.flagged } });
+				}
+			}
+		}
+		statsJson["threads"] = stats.threads;
+
+		std::ofstream json(dir / "StockControl_Stats.json");
+		if (!json.is_open()) {
+			logger::error("Failed to write statistics to {}", dir.string());
+			return false;
+		}
+		json << statsJson.dump(1, '\t');
+		logger::info("Wrote engine statistics to {}", dir.string());
+		return true;
+	}
+
+	// Spans recorded since tracing was enabled or last written, as StockControl_Trace.json in `dir`
+	bool WriteTrace(const std::filesystem::path& dir) {
+		auto trace = Trace::getInstance();
+		if (!trace->Enabled()) return false;
+		const std::vector<ConfigEntry>* sections[] = { &buyPriceEntries, &sellPriceEntries, &countEntries };
+		return trace->Write(dir / "StockControl_Trace.json", [&](const Trace::Event& e) -> nlohmann::json {
+			if (e.arg == Trace::kNoArg) return nullptr;
+			for (size_t k = 0; k < 3; ++k) {
+				if (e.category == kSectionNames[k] && e.arg < sections[k]->size()) return { { "entry", (*sections[k])[e.arg].Origin() } };
+			}
+			return { { "n", e.arg } };
+		});
+	}
+
+	// Starts a fresh measurement window
+	void ResetStats() {
+		Telemetry::getInstance()->Reset();
+		profiler.Reset();
+		if (pool) pool->ResetStats();
+		logger::info("Engine statistics reset");
+	}
+
+	// Starts recording every price call and restock with the state the config reads, replacing `path`
+	bool StartCapture(const std::filesystem::path& path) {
+		capture.Close();
+		if (!capture.Open(path)) {
+			logger::error("Failed to open capture file {}", path.string());
+			return false;
+		}
+		CollectCaptureInputs();
+		logger::info("Capturing price calls and restocks to {} ({} skills, {} perks, {} globals per record)",
+			path.string(), captureInputs.skills.size(), captureInputs.perks.size(), captureInputs.globals.size());
+		return true;
+	}
+
+	// Records written
+	std::uint64_t StopCapture() {
+		if (!capture.IsOpen()) return 0;
+		capture.Close();
+		logger::info("Capture stopped after {} records", capture.Records());
+		return capture.Records();
+	}
+
+	bool Capturing() const { return capture.IsOpen(); }
+
+	void CapturePrice(RE::Actor* trader, RE::InventoryEntryData* item, RE::PlayerCharacter* player, bool buying, float multiplier) {
+		if (!capture.IsOpen() || !trader || !item || !item->object) return;
+		capture.Write(Capture::Price{ .state = CaptureState(trader, player),
+			.item = { item->object->GetFormID(), item->countDelta, ValueCache::getInstance()->Get(item), item->object->GetWeight(), 0 },
+			.buying = buying,
+			.multiplier = multiplier,
+			.rolls = rolls });
+	}
+
+	// Runs every call of a capture again against its recorded merchant, player and global state, timing
+	// them and comparing the results. Stacks are rebuilt from their base form with the recorded value and
+	// ranged entries take the values they rolled in the capture. A call that rolls an entry the capture has
+	// no value for (the config changed since) is counted as re-rolled rather than as a mismatch.
+	std::vector<std::string> ReplayCapture(const std::filesystem::path& path) {
+		std::vector<std::string> lines;
+		auto file = Capture::File::Load(path);
+		auto player = RE::PlayerCharacter::GetSingleton();
+		if (!file || !player) {
+			lines.push_back(std::format("No readable capture at {}", path.string()));
+			return lines;
+		}
+
+		StopPriceTables();
+
+		// The live state comes back however the replay ends; the game's own globals are never written
+		struct Restore {
+			ConfigManager& cfg;
+			spdlog::level::level_enum level = spdlog::get_level();
+
+			~Restore() {
+				cfg.replayingRolls = false;
+				cfg.rolls.clear();
+				cfg.gameState.Pin(false);
+				ValueCache::getInstance()->Clear("capture replay");
+				cfg.ResetSessionMemo();
+				cfg.trader_id = 0;
+				cfg.buyPrice_cache.clear();
+				cfg.sellPrice_cache.clear();
+				spdlog::set_level(level);
+			}
+		} restore{ *this };
+		spdlog::set_level(spdlog::level::info);
+		replayingRolls = true;
+
+		struct Tally {
+			std::uint64_t calls = 0;
+			std::uint64_t items = 0;
+			std::uint64_t differ = 0;
+			std::uint64_t skipped = 0;
+			std::uint64_t rerolled = 0;
+			double ns = 0.0;
+		};
+		Tally prices, restocks;
+
+		auto seed = [&](const Capture::State& state) -> RE::Actor* {
+			auto trader = RE::TESForm::LookupByID<RE::Actor>(state.trader);
+			if (!trader) return nullptr;
+			gameState.Pin(true);
+			gameState.SeedTraderBase(state.traderBase);
+			gameState.SeedRelationship(state.relationship);
+			gameState.SeedLevel(state.level);
+			for (auto&& [id, value] : state.skills) gameState.SeedSkill(id, value);
+			for (auto&& [id, has] : state.perks) {
+				if (auto perk = RE::TESForm::LookupByID<RE::BGSPerk>(id)) gameState.SeedPerk(perk, has);
+			}
+			for (auto&& [id, value] : state.globals) {
+				if (auto global = RE::TESForm::LookupByID<RE::TESGlobal>(id)) gameState.SeedGlobal(global, value);
+			}
+			ResetSessionMemo();
+			return trader;
+		};
+		auto elapsed = [](std::chrono::steady_clock::time_point start) {
+			return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		};
+
+		const bool complete = file->ForEach(
+			[&](const Capture::Price& price) {
+				auto trader = seed(price.state);
+				auto object = RE::TESForm::LookupByID<RE::TESBoundObject>(price.item.form);
+				if (!trader || !object) {
+					++prices.skipped;
+					return;
+				}
+				RE::InventoryEntryData item(object, price.item.count);
+				ValueCache::getInstance()->Seed(&item, price.item.value);
+				rolls = price.rolls;
+				const auto unrecorded = unrecordedRolls;
+
+				const auto start = std::chrono::steady_clock::now();
+				const float multiplier = price.buying ? GetBuyPriceMultiplier(trader, &item, player) : GetSellPriceMultiplier(trader, &item, player);
+				prices.ns += elapsed(start);
+				++prices.calls;
+				++prices.items;
+				if (std::abs(multiplier - price.multiplier) > 1e-4f * std::max(1.0f, std::abs(price.multiplier))) {
+					++(unrecordedRolls != unrecorded ? prices.rerolled : prices.differ);
+					logger::debug("Replay: {} price multiplier of {:08X} at {:08X} was {}, now {}", price.buying ? "buy" : "sell",
+						price.item.form, price.state.trader, price.multiplier, multiplier);
+				}
+			},
+			[&](const Capture::Restock& restock) {
+				auto trader = seed(restock.state);
+				if (!trader) {
+					++restocks.skipped;
+					return;
+				}
+				std::deque<RE::InventoryEntryData> stacks;
+				std::vector<RE::InventoryEntryData*> items;
+				std::vector<const Capture::Item*> recorded;
+				std::vector<std::uint32_t> replayed(restock.items.size(), UINT32_MAX);  // recorded stack -> replayed stack
+				for (size_t r = 0; r < restock.items.size(); ++r) {
+					const auto& item = restock.items[r];
+					auto object = RE::TESForm::LookupByID<RE::TESBoundObject>(item.form);
+					if (!object) continue;
+					auto& stack = stacks.emplace_back(object, item.count);
+					ValueCache::getInstance()->Seed(&stack, item.value);
+					replayed[r] = static_cast<std::uint32_t>(items.size());
+					items.push_back(&stack);
+					recorded.push_back(&item);
+				}
+				rolls.clear();
+				for (auto roll : restock.rolls) {
+					if (roll.item >= replayed.size() || replayed[roll.item] == UINT32_MAX) continue;
+					roll.item = replayed[roll.item];
+					rolls.push_back(roll);
+				}
+				const auto unrecorded = unrecordedRolls;
+
+				const auto start = std::chrono::steady_clock::now();
+				RestockItems(trader, items, player);
+				restocks.ns += elapsed(start);
+				++restocks.calls;
+				restocks.items += items.size();
+				for (size_t n = 0; n < items.size(); ++n) {
+					if (items[n]->countDelta == recorded[n]->result) continue;
+					++(unrecordedRolls != unrecorded ? restocks.rerolled : restocks.differ);
+					logger::debug("Replay: restock of {:08X} in {:08X} was {}, now {}", recorded[n]->form, restock.owner, recorded[n]->result, items[n]->countDelta);
+				}
+			});
+
+		lines.push_back(std::format("Replayed {}{}", path.filename().string(), complete ? "" : " (truncated)"));
+		lines.push_back(std::format("  {} price calls: {:.0f} ns mean, {} differ from the capture, {} re-rolled, {} skipped for missing forms",
+			prices.calls, prices.calls ? prices.ns / prices.calls : 0.0, prices.differ, prices.rerolled, prices.skipped));
+		lines.push_back(std::format("  {} restocks of {} stacks: {:.0f} ns mean, {} stacks differ, {} re-rolled, {} skipped for missing forms",
+			restocks.calls, restocks.items, restocks.calls ? restocks.ns / restocks.calls : 0.0, restocks.differ, restocks.rerolled, restocks.skipped));
+		for (const auto& line : lines) logger::info("{}", line);
+		return lines;
+	}
+
+	// One-shot snapshot of every tradeable base form and every vendor NPC for offline tools (engine/formdump.h)
+	bool ExportForms(const std::filesystem::path& path) {
+		auto dataHandler = RE::TESDataHandler::GetSingleton();
+		if (!dataHandler) return false;
+		Trace::Span span("ExportForms", "export");
+		const auto start = std::chrono::steady_clock::now();
+
+		FormDump::Builder dump;
+		std::vector<std::uint32_t> ids;
+		ForEachTradeableForm([&](RE::TESBoundObject* object) {
+			ids.clear();
+			if (auto keywordForm = object->As<RE::BGSKeywordForm>()) {
+				for (std::uint32_t k = 0; k < keywordForm->numKeywords; ++k) {
+					if (auto keyword = keywordForm->keywords[k]) ids.push_back(keyword->GetFormID());
+				}
+			}
+			dump.Add(FormDump::Form{ .formID = object->GetFormID(),
+				.editorID = dump.String(EditorIDOf(object)),
+				.keywords = dump.Ids(ids),
+				.weight = object->GetWeight(),
+				.value = object->GetGoldValue(),
+				.type = static_cast<std::uint8_t>(object->GetFormType()) });
+		});
+
+		std::vector<std::uint32_t> containers;
+		for (auto npc : dataHandler->GetFormArray<RE::TESNPC>()) {
+			if (!npc) continue;
+			ids.clear();
+			containers.clear();
+			bool vendor = false;
+			for (auto&& rank : npc->factions) {
+				if (!rank.faction) continue;
+				ids.push_back(rank.faction->GetFormID());
+				if (!rank.faction->IsVendor()) continue;
+				vendor = true;
+				auto chest = rank.faction->vendorData.merchantContainer;
+				if (chest && std::ranges::find(containers, chest->GetFormID()) == containers.end()) containers.push_back(chest->GetFormID());
+			}
+			if (!vendor) continue;
+			dump.Add(FormDump::Vendor{ .formID = npc->GetFormID(),
+				.editorID = dump.String(EditorIDOf(npc)),
+				.factions = dump.Ids(ids),
+				.containers = dump.Ids(containers) });
+		}
+
+		if (!dump.Write(path)) {
+			logger::error("Failed to write form export to {}", path.string());
+			return false;
+		}
+		logger::info("Exported {} forms and {} vendors to {} in {:.1f} ms", dump.Forms(), dump.Vendors(), path.string(),
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		return true;
+	}
+
+	// Warms the caches the first restock or barter of every vendor in `cell` reads, as a Scheduler task
+	// sharing the FrameBudgetMs of the other deferred work
+	void PrewarmCell(RE::TESObjectCELL* cell) {
+		if (!cell) return;
+		Scheduler::getInstance()->Spawn(std::format("prewarm {}", cell->GetFormEditorID()), PrewarmVendors(cell, ++prewarmGeneration));
+	}
+
+	// Saves the learned predicate statistics outside of the save game callback
+	void FlushPredicateStats() {
+		Scheduler::getInstance()->Spawn("save predicate stats", SavePredicateStatsTask());
+	}
+
+	void SavePredicateStats() const {
+		predicateStats.Save(kPredicateStatsPath);
+	}
+
+	// Times the reference evaluator, the bytecode interpreter and the JIT on synthetic sections of
+	// 100, 1,000 and 10,000 entries made by repeating the loaded entries, over the player's inventory
+	void RunBenchmark() {
+		auto player = RE::PlayerCharacter::GetSingleton();
+		std::vector<const ConfigEntry*> templates;
+		for (auto* list : { &buyPriceEntries, &sellPriceEntries, &countEntries }) {
+			for (const auto& entry : *list) templates.push_back(&entry);
+		}
+		if (!player || templates.empty()) {
+			logger::warn("Benchmark skipped: no player or no entries loaded");
+			return;
+		}
+
+		auto inventory = player->GetInventory();
+		std::vector<RE::InventoryEntryData*> items;
+		for (auto&& [object, data] : inventory) items.push_back(data.second.get());
+		if (items.empty()) {
+			logger::warn("Benchmark skipped: player inventory is empty");
+			return;
+		}
+
+		// logging inside the reference evaluator would dominate the timings
+		auto level = spdlog::get_level();
+		spdlog::set_level(spdlog::level::info);
+
+		// The synthetic sections intern, dedupe and profile against throwaway copies, so nothing they
+		// compile or measure reaches the dedupe report, Reoptimize or the saved statistics
+		auto liveStats = predicateStats;
+		auto liveShared = std::exchange(uniqueShared, {});
+		const auto liveCompiledShared = std::exchange(compiledShared, 0);
+		const auto liveProfileTick = profileTick;
+
+		for (size_t count : { 100, 1000, 10000 }) {
+			std::vector<ConfigEntry> entries;
+			entries.reserve(count);
+			for (size_t i = 0; i < count; ++i) entries.push_back(*templates[i % templates.size()]);
+
+			SectionKernel section;
+			BuildKernel(section, entries, "Benchmark");
+			if (!section.jit) section.jit = FilterJIT::Compile(section.program, section.entryStart);
+
+			size_t reps = std::max<size_t>(1, 2'000'000 / (count * items.size()));
+			RuleMask rows, matched;
+			size_t hits[3] = {};
+
+			auto time = [&](auto&& body) {
+				auto start = std::chrono::steady_clock::now();
+				for (size_t r = 0; r < reps; ++r) {
+					for (auto item : items) body(item);
+				}
+				return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (reps * items.size());
+			};
+
+			double reference = time([&](RE::InventoryEntryData* item) {
+				for (const auto& entry : entries) hits[0] += MatchesFilters(entry.filters, player, item, player);
+			});
+			double bytecode = time([&](RE::InventoryEntryData* item) {
+				EvaluateItemRows(section, item, rows);
+				FilterVM::Context ctx{ item, player, player, &rows };
+				for (size_t i = 0; i < count; ++i) hits[1] += MatchesEntry(section, i, ctx);
+			});
+			double native = !section.jit ? 0.0 : time([&](RE::InventoryEntryData* item) {
+				EvaluateItemRows(section, item, rows);
+				FilterVM::Context ctx{ item, player, player, &rows };
+				matched.Resize(count);
+				section.jit->Run(ctx, rows, matched);
+				hits[2] += matched.Count();
+			});
+
+			logger::info("Benchmark {} entries x {} items: reference {:.0f} ns, bytecode {:.0f} ns, JIT {:.0f} ns per item (matches {}/{}/{})",
+				count, items.size(), reference, bytecode, native, hits[0], hits[1], hits[2]);
+
+			// Sampling profiler overhead on the production path, against the same path with sampling off
+			if (profiler.Enabled()) {
+				auto saved = profiler;
+				std::vector<size_t> all(count);
+				std::iota(all.begin(), all.end(), size_t{ 0 });
+				auto production = [&](RE::InventoryEntryData* item) {
+					EvaluateItemRows(section, item, rows);
+					FilterVM::Context ctx{ item, player, player, &rows };
+					MatchEntries(section, ctx, all, matched);
+				};
+				// Unsampled runs on both sides of the sampled one, so warm-up does not count as overhead
+				profiler.Configure(0, 0, saved.BudgetMs(), {});
+				double off = time(production);
+				profiler.Configure(saved.RuleEvery(), saved.CallEvery(), saved.BudgetMs(), { 0, 0, count });
+				double on = time(production);
+				profiler.Configure(0, 0, saved.BudgetMs(), {});
+				off = (off + time(production)) / 2;
+				profiler = std::move(saved);
+				const double overhead = off > 0.0 ? 100.0 * (on - off) / off : 0.0;
+				if (overhead < 1.0) {
+					logger::info("Benchmark {} entries: sampling profiler overhead {:.2f}% ({:.0f} ns sampled, {:.0f} ns unsampled per item)", count, overhead, on, off);
+				} else {
+					logger::warn("Benchmark {} entries: sampling profiler overhead {:.2f}% ({:.0f} ns sampled, {:.0f} ns unsampled per item)", count, overhead, on, off);
+				}
+			}
+		}
+		predicateStats = std::move(liveStats);
+		uniqueShared = std::move(liveShared);
+		compiledShared = liveCompiledShared;
+		profileTick = liveProfileTick;
+		spdlog::set_level(level);
+	}
+
 private:
 	std::string configPath;
+	EngineSettings settings;
+
+	// Learned per-predicate cost and selectivity, persisted between sessions to order checks
+	static constexpr const char* kPredicateStatsPath = "Data/SKSE/Plugins/StockControl_PredicateStats.json";
+	static constexpr std::uint32_t kProfileInterval = 64;
+	PredicateStats predicateStats;
+	std::uint32_t profileTick = 0;
+	RuleProfiler profiler;  // sampled per-rule and per-call costs of the current stats window
+
+	// Hash-consed merchant/player predicates: MemoState per predicate ID for the current session
+	std::vector<std::uint8_t> sessionMemo;
+	RE::FormID memoTrader = 0;  // actor the memo's results were computed for
+	size_t compiledShared = 0;
+	std::unordered_set<std::uint32_t> uniqueShared;
+	FilterVM::Snapshot gameState;  // merchant/player state of the current call or restock batch
+
+	// Opt-in record of price calls and restocks, with the game state inputs the compiled config reads
+	struct CaptureInputs {
+		std::vector<std::uint16_t> skills;
+		std::vector<RE::BGSPerk*> perks;
+		std::vector<RE::TESGlobal*> globals;
+	};
+	Capture::Writer capture;
+	std::vector<Capture::Roll> rolls;  // ranged values of the current call: collected for its capture, or replayed
+	bool replayingRolls = false;
+	std::uint64_t unrecordedRolls = 0;  // replay: ranged values rolled anew as the capture holds none for them
+	CaptureInputs captureInputs;
+
+	// Prices of both sides of the open barter menu, filled by the priceJob tasks
+	std::shared_ptr<PriceTable> buyTable;
+	std::shared_ptr<PriceTable> sellTable;
+	std::array<RuleMask, 2> priceEligible;  // buy, sell; only rewritten after priceJob finished
+	std::chrono::steady_clock::time_point priceCaptured;
+	ThreadPool::Group priceJob;
+	std::uint64_t servedFromTable = 0;
+	std::uint64_t servedInline = 0;
+
+	// Shared background workers, sized by WorkerThreads
+	std::unique_ptr<ThreadPool> pool;
+
+	// Vendor state resolved ahead of the first restock or barter
+	std::unordered_map<RE::FormID, std::array<RuleMask, 3>> traderVerdicts;  // per trader: buy, sell, count
+	std::uint32_t prewarmGeneration = 0;  // a newer cell load abandons the previous prewarm
+
+	// One vendor per step: relationship rank and form verdicts, then the values of its merchant chest.
+	// References are held by handle across suspensions, as they may unload in between.
+	// Only inputs are warmed, no count or price table is built: those depend on the player's state at the
+	// time of the restock or barter. The rank serves restocks only, BeginSession looks it up again.
+	FrameTask PrewarmVendors(RE::TESObjectCELL* cell, std::uint32_t generation) {
+		auto player = RE::PlayerCharacter::GetSingleton();
+		std::vector<RE::ActorHandle> vendors;
+		cell->ForEachReference([&](RE::TESObjectREFR* ref) {
+			auto actor = ref ? ref->As<RE::Actor>() : nullptr;
+			if (actor && actor != player && actor->GetVendorFaction()) vendors.push_back(actor->GetHandle());
+			return RE::BSContainer::ForEachResult::kContinue;
+		});
+		logger::debug("Prewarming {} vendors in {}", vendors.size(), cell->GetFormEditorID());
+
+		for (auto handle : vendors) {
+			co_await Scheduler::Budget{};
+			if (generation != prewarmGeneration) co_return;
+
+			RE::ObjectRefHandle chest;
+			if (auto actor = handle.get()) {
+				RelationshipCache::getInstance()->Get(actor.get());
+				for (auto section : { &buyKernel, &sellKernel, &countKernel }) TraderVerdicts(*section, actor.get());
+				auto faction = actor->GetVendorFaction();
+				if (faction && faction->vendorData.merchantContainer) chest = faction->vendorData.merchantContainer->GetHandle();
+			}
+
+			co_await Scheduler::Budget{};
+			if (generation != prewarmGeneration) co_return;
+			if (auto ref = chest.get()) {
+				ForEachStack(ref.get(), [](RE::InventoryEntryData* stack) { ValueCache::getInstance()->Get(stack); });
+			}
+		}
+	}
+
+	FrameTask SavePredicateStatsTask() {
+		SavePredicateStats();
+		co_return;
+	}
+
 	std::vector<ConfigEntry> buyPriceEntries;
 	std::vector<ConfigEntry> sellPriceEntries;
 	std::vector<ConfigEntry> countEntries;
 	RE::FormID trader_id;
-	std::map<std::pair<int, RE::FormID>, float> buyPrice_cache;
-	std::map<std::pair<int, RE::FormID>, float> sellPrice_cache;
+	std::map<std::pair<int, std::uint64_t>, float> buyPrice_cache; // keyed by entry and MemoKey
+	std::map<std::pair<int, std::uint64_t>, float> sellPrice_cache;
+
+	// Form/keyword part of an item filter with its editor IDs looked up
+	struct ResolvedItemRow {
+		RE::FormID formID = 0;
+		std::uint32_t keyword = KeywordIndex::kNone;  // dense keyword index
+		bool unresolved = false;
+
+		ResolvedItemRow(const ItemFilter& filter) {
+			if (!filter.formEditorID.empty()) {
+				auto form = RE::TESForm::LookupByEditorID(filter.formEditorID);
+				unresolved |= !form;
+				formID = form ? form->formID : 0;
+			}
+			if (!filter.keywordEditorID.empty()) {
+				auto form = RE::TESForm::LookupByEditorID<RE::BGSKeyword>(filter.keywordEditorID);
+				unresolved |= !form;
+				keyword = KeywordIndex::getInstance()->Assign(form);
+			}
+		}
+
+		// `keywords` is the object's KeywordIndex mask
+		bool Matches(RE::TESBoundObject* object, const std::uint64_t* keywords) const {
+			return Matches(object->GetFormID(), keywords);
+		}
+
+		bool Matches(RE::FormID object, const std::uint64_t* keywords) const {
+			if (unresolved) return false;
+			if (formID && object != formID) return false;
+			return keyword == KeywordIndex::kNone || KeywordIndex::Test(keywords, keyword);
+		}
+	};
+
+	// Weight/value thresholds of every item filter in a section, one kernel row per filter
+	struct SectionKernel {
+		ComparisonKernel kernel;
+		std::vector<size_t> rowBase;            // first kernel row of each entry
+		std::vector<RuleMask> ruleRows;         // kernel rows belonging to each entry
+		std::vector<ResolvedItemRow> resolved;  // form/keyword part of each row
+		std::vector<RuleMask> classRows;        // static (form, keyword, weight) row results per item class
+
+		StaticMultiplierTable staticTable;      // product of all fully static entries per base form
+		std::vector<size_t> allEntries;
+		std::vector<size_t> dynamicEntries;     // entries still evaluated per call when the form is folded
+		std::vector<std::pair<size_t, size_t>> folds;  // (entry, implied entry folded into it), implied entries first
+		std::vector<std::vector<RE::FormID>> merchantForms;  // forms each entry's merchant filters require, 0 if unresolved
+
+		FilterVM::Program program;              // bytecode of every entry's filter set
+		std::vector<std::uint32_t> entryStart;  // first instruction of each entry
+		std::vector<std::uint32_t> actorStart;  // first merchant/player instruction of each entry
+		std::unique_ptr<FilterJIT> jit;         // native code for the whole section, null when interpreted
+	};
+
+	// Base forms sharing the same static results in every section share one item class
+	std::unordered_map<RE::FormID, std::uint32_t> formClass;
+	SectionKernel buyKernel;
+	SectionKernel sellKernel;
+	SectionKernel countKernel;
 
 	ConfigManager(const char* path) : configPath(path) {
 		logger::info("Initializing ConfigManager with path: {}", path);
+		predicateStats.Load(kPredicateStatsPath);
 		LoadConfig(path);
 	}
 
-	bool LoadConfig(const std::string& path) {
-		try {
-			std::filesystem::directory_iterator dir(path);
+	void BuildKernel(SectionKernel& section, const std::vector<ConfigEntry>& entries, const char* name) {
+		section.kernel.Clear();
+		section.rowBase.clear();
+		section.ruleRows.clear();
+		section.resolved.clear();
+		section.classRows.clear();
+		for (const auto& entry : entries) {
+			section.rowBase.push_back(section.kernel.Rows());
+			for (const auto& itemFilter : entry.filters.itemFilters) {
+				section.kernel.AddRow(itemFilter.weightFilter.AcceptMask(), itemFilter.weightFilter.value,
+					itemFilter.valueFilter.AcceptMask(), itemFilter.valueFilter.value);
+				section.resolved.emplace_back(itemFilter);
+			}
+		}
+		for (size_t i = 0; i < entries.size(); ++i) {
+			auto& rows = section.ruleRows.emplace_back(section.kernel.Rows());
+			for (size_t r = 0; r < entries[i].filters.itemFilters.size(); ++r) rows.Set(section.rowBase[i] + r);
+		}
+		section.allEntries.resize(entries.size());
+		std::iota(section.allEntries.begin(), section.allEntries.end(), size_t{ 0 });
+
+		section.merchantForms.assign(entries.size(), {});
+		for (size_t i = 0; i < entries.size(); ++i) {
+			for (const auto& merchantFilter : entries[i].filters.merchantFilters) {
+				if (merchantFilter.formEditorID.empty()) continue;
+				auto form = RE::TESForm::LookupByEditorID(merchantFilter.formEditorID);
+				section.merchantForms[i].push_back(form ? form->GetFormID() : 0);
+			}
+		}
 
-			for (auto&& file_ : dir) {
-				logger::info("Loading configuration from: {}", file_.path().string());
+		CompileAndJIT(section, entries, name);
+		logger::debug("Built {} comparison kernel with {} rows", name, section.kernel.Rows());
+	}
 
-				std::ifstream file(file_.path());
-				if (!file.is_open()) {
-					logger::error("Failed to open config file: {}", file_.path().string());
-					return false;
-				}
+	// One AND-ed check of an entry. Groups within the item part, and within the merchant/player part,
+	// can run in any order, so they are sorted by learned cost per rejection.
+	struct PredicateGroup {
+		std::uint32_t stat;
+		double defaultCost;  // rdtsc ticks assumed until enough samples are gathered
+		std::vector<FilterVM::Instr> code;
+	};
+
+	static double DefaultCost(FilterVM::Op op) {
+		using FilterVM::Op;
+		switch (op) {
+			case Op::LoadValue: return 400.0;
+			case Op::LoadRelationship: return 150.0;
+			case Op::TestPerk: return 80.0;
+			case Op::LoadSkill: return 60.0;
+			case Op::TestKeyword: return 40.0;
+			case Op::LoadLevel: return 30.0;
+			case Op::LoadWeight: return 20.0;
+			case Op::TestMerchantForm: return 20.0;
+			default: return 5.0;
+		}
+	}
 
-				nlohmann::json configJson;
-				file >> configJson;
-				logger::debug("Successfully parsed JSON from config file");
-
-				// Load buy price entries
-				if (configJson.contains("BuyPrices")) {
-					logger::debug("Loading buy price entries from config");
-					for (size_t i = 0; i < configJson["BuyPrices"].size(); ++i) {
-						logger::trace("Loading buy price entry {}", i + 1);
-						buyPriceEntries.emplace_back(configJson["BuyPrices"][i]);
-					}
-					logger::info("Loaded {} buy price entries", buyPriceEntries.size());
-				}
-				else {
-					logger::warn("No 'BuyPrices' section found in config");
-				}
+	PredicateGroup& AddGroup(std::vector<PredicateGroup>& groups, const std::string& signature) {
+		return groups.emplace_back(PredicateGroup{ predicateStats.Intern(signature), 0.0, {} });
+	}
 
-				// Load sell price entries
-				if (configJson.contains("SellPrices")) {
-					logger::debug("Loading sell price entries from config");
-					for (size_t i = 0; i < configJson["SellPrices"].size(); ++i) {
-						logger::trace("Loading sell price entry {}", i + 1);
-						sellPriceEntries.emplace_back(configJson["SellPrices"][i]);
-					}
-					logger::info("Loaded {} sell price entries", sellPriceEntries.size());
-				}
-				else {
-					logger::warn("No 'SellPrices' section found in config");
+	static void Push(PredicateGroup& group, FilterVM::Instr in) {
+		group.code.push_back(in);
+		group.defaultCost += DefaultCost(in.op);
+	}
+
+	static std::string CompareSignature(const ComparisonFilter& filter) {
+		return std::format("{}:{}", filter.AcceptMask(), filter.value);
+	}
+
+	// Compiles every entry of a section to bytecode laid out as [item ops][merchant/player ops] Accept.
+	// Editor IDs are resolved here once; an unresolved one compiles to Fail, as the lookup would fail per call.
+	void CompileSection(SectionKernel& section, const std::vector<ConfigEntry>& entries, const char* name) {
+		using FilterVM::Op;
+		auto& program = section.program;
+		program.Clear();
+		section.entryStart.clear();
+		section.actorStart.clear();
+
+		// Merchant/player groups are hash-consed by signature across all sections and wrapped in Memo/MemoPass,
+		// so each unique one runs at most once per session. Item groups are already one kernel row test per call.
+		auto emitSorted = [&](std::vector<PredicateGroup>& groups, bool shared) {
+			std::stable_sort(groups.begin(), groups.end(), [&](const PredicateGroup& a, const PredicateGroup& b) {
+				return predicateStats.Rank(a.stat, a.defaultCost) < predicateStats.Rank(b.stat, b.defaultCost);
+			});
+			for (const auto& group : groups) {
+				if (shared) program.Emit({ .op = Op::Memo, .skip = static_cast<std::uint16_t>(group.code.size() + 1), .operand = group.stat }, group.stat);
+				for (const auto& in : group.code) program.Emit(in, group.stat);
+				if (shared) program.Emit({ .op = Op::MemoPass, .operand = group.stat }, group.stat);
+			}
+		};
+
+		std::vector<PredicateGroup> groups;
+		for (size_t i = 0; i < entries.size(); ++i) {
+			const auto& filters = entries[i].filters;
+			section.entryStart.push_back(static_cast<std::uint32_t>(program.code.size()));
+
+			groups.clear();
+			if (!filters.itemFilters.empty()) {
+				program.Emit({ Op::RequireItem });
+				for (size_t r = 0; r < filters.itemFilters.size(); ++r) {
+					CompileItemFilter(program, groups, filters.itemFilters[r], static_cast<std::uint32_t>(section.rowBase[i] + r));
 				}
+				emitSorted(groups, false);
+			}
+
+			section.actorStart.push_back(static_cast<std::uint32_t>(program.code.size()));
+			groups.clear();
+			if (!filters.merchantFilters.empty()) {
+				program.Emit({ Op::RequireTrader });
+				for (const auto& merchantFilter : filters.merchantFilters) CompileMerchantFilter(program, groups, merchantFilter);
+			}
+			if (!filters.playerFilters.empty()) {
+				program.Emit({ Op::RequirePlayer });
+				for (const auto& playerFilter : filters.playerFilters) CompilePlayerFilter(program, groups, playerFilter);
+			}
+			emitSorted(groups, true);
+			program.Emit({ Op::Accept });
+		}
+		logger::debug("Compiled {} {} entries to {} instructions", entries.size(), name, program.code.size());
+	}
+
+	static void EmitCompare(PredicateGroup& group, FilterVM::Op load, const ComparisonFilter& filter, std::uint32_t operand = 0) {
+		if (filter.type == ComparisonFilter::NONE) return;
+		Push(group, { .op = load, .operand = operand });
+		Push(group, { .op = FilterVM::Op::Compare, .accept = static_cast<std::uint8_t>(filter.AcceptMask()), .imm = filter.value });
+	}
+
+	// One group per item filter: the row test plus its expansion for callers without precomputed rows
+	void CompileItemFilter(FilterVM::Program& program, std::vector<PredicateGroup>& groups, const ItemFilter& filter, std::uint32_t row) {
+		using FilterVM::Op;
+		auto& group = AddGroup(groups, std::format("item:{}|{}|{}|{}", filter.formEditorID, filter.keywordEditorID,
+			CompareSignature(filter.weightFilter), CompareSignature(filter.valueFilter)));
+		Push(group, { .op = Op::Row, .operand = row });
+		if (!filter.formEditorID.empty()) {
+			auto form = RE::TESForm::LookupByEditorID(filter.formEditorID);
+			Push(group, form ? FilterVM::Instr{ .op = Op::TestItemForm, .operand = form->formID } : FilterVM::Instr{ Op::Fail });
+		}
+		if (!filter.keywordEditorID.empty()) {
+			auto keyword = RE::TESForm::LookupByEditorID<RE::BGSKeyword>(filter.keywordEditorID);
+			Push(group, keyword ? FilterVM::Instr{ .op = Op::TestKeyword, .operand = KeywordIndex::getInstance()->Assign(keyword) } : FilterVM::Instr{ Op::Fail });
+		}
+		EmitCompare(group, Op::LoadWeight, filter.weightFilter);
+		EmitCompare(group, Op::LoadValue, filter.valueFilter);
+		group.code.front().skip = static_cast<std::uint16_t>(group.code.size() - 1);
+		group.defaultCost = DefaultCost(Op::Row);  // the expansion only runs without precomputed rows
+	}
+
+	void CompileMerchantFilter(FilterVM::Program& program, std::vector<PredicateGroup>& groups, const MerchantFilter& filter) {
+		using FilterVM::Op;
+		if (!filter.formEditorID.empty()) {
+			auto form = RE::TESForm::LookupByEditorID(filter.formEditorID);
+			Push(AddGroup(groups, "merchant.form:" + filter.formEditorID),
+				form ? FilterVM::Instr{ .op = Op::TestMerchantForm, .operand = form->formID } : FilterVM::Instr{ Op::Fail });
+		}
+		if (filter.relationship.type != ComparisonFilter::NONE) {
+			EmitCompare(AddGroup(groups, "merchant.relationship:" + CompareSignature(filter.relationship)), Op::LoadRelationship, filter.relationship);
+		}
+		if (!filter.globalCondition.globalEditorID.empty()) {
+			auto& group = AddGroup(groups, std::format("merchant.global:{}:{}", filter.globalCondition.globalEditorID, CompareSignature(filter.globalCondition.againstValue)));
+			auto global = RE::TESForm::LookupByEditorID<RE::TESGlobal>(filter.globalCondition.globalEditorID);
+			if (!global) Push(group, { Op::Fail });
+			else EmitCompare(group, Op::LoadGlobal, filter.globalCondition.againstValue, program.Pool(global));
+			if (group.code.empty()) groups.pop_back();
+		}
+	}
+
+	void CompilePlayerFilter(FilterVM::Program& program, std::vector<PredicateGroup>& groups, const PlayerFilter& filter) {
+		using FilterVM::Op;
+		if (filter.levelFilter.type != ComparisonFilter::NONE) {
+			EmitCompare(AddGroup(groups, "player.level:" + CompareSignature(filter.levelFilter)), Op::LoadLevel, filter.levelFilter);
+		}
+		if (filter.skillID >= 0 && filter.skillLevel >= 0) {
+			auto& group = AddGroup(groups, std::format("player.skill:{}>={}", filter.skillID, filter.skillLevel));
+			Push(group, { .op = Op::LoadSkill, .operand = static_cast<std::uint32_t>(filter.skillID) });
+			Push(group, { .op = Op::Compare, .accept = static_cast<std::uint8_t>(ComparisonKernel::kGreater | ComparisonKernel::kEqual), .imm = static_cast<float>(filter.skillLevel) });
+		}
+		if (!filter.perkEditorID.empty()) {
+			auto perk = RE::TESForm::LookupByEditorID<RE::BGSPerk>(filter.perkEditorID);
+			Push(AddGroup(groups, "player.perk:" + filter.perkEditorID),
+				perk ? FilterVM::Instr{ .op = Op::TestPerk, .operand = program.Pool(perk) } : FilterVM::Instr{ Op::Fail });
+		}
+	}
+
+	bool MatchesEntry(const SectionKernel& section, size_t i, const FilterVM::Context& ctx) const {
+		return FilterVM::Run(section.program, section.entryStart[i], ctx);
+	}
+
+	// Sets the bit of every matching entry in `entries`, natively when the section is JIT compiled.
+	// Every kProfileInterval-th call goes through the profiling interpreter to feed predicateStats;
+	// the others feed the sampling profiler.
+	void MatchEntries(const SectionKernel& section, const FilterVM::Context& ctx, const std::vector<size_t>& entries, RuleMask& matched) {
+		Trace::Span span("MatchEntries", "batch", static_cast<std::uint32_t>(entries.size()));
+		matched.Resize(section.entryStart.size());
+		const size_t k = SectionIndex(section);
+		const bool timeCall = profiler.SampleCall(k);
+		if (++profileTick % kProfileInterval == 0) {
+			// Profiled calls double as the sample of per-rule spans
+			for (size_t i : entries) {
+				Trace::Span rule("Rule", kSectionNames[k], static_cast<std::uint32_t>(i));
+				if (FilterVM::RunProfiled(section.program, section.entryStart[i], ctx, predicateStats)) matched.Set(i);
+			}
+			return;
+		}
+
+		const std::uint64_t callStart = timeCall ? __rdtsc() : 0;
+		const bool rulesDue = profiler.RulesDue(entries.size());
+		if (section.jit && ctx.rows) {
+			section.jit->Run(ctx, *ctx.rows, matched);
+		} else {
+			profiler.Evaluate(k, entries, rulesDue, [&](size_t i) { return MatchesEntry(section, i, ctx); }, [&](size_t i) { matched.Set(i); });
+		}
+		if (timeCall) profiler.RecordCall(k, __rdtsc() - callStart);
+
+		// Native code runs all entries at once, so the sampled ones are timed separately through the interpreter
+		if (rulesDue && section.jit && ctx.rows) {
+			for (size_t i : entries) {
+				if (!profiler.SampleRule()) continue;
+				const auto start = __rdtsc();
+				const bool hit = MatchesEntry(section, i, ctx);
+				profiler.RecordRule(k, i, __rdtsc() - start, hit);
+			}
+		}
+		if (rulesDue && profiler.HasFindings()) ReportFlaggedRules();
+	}
+
+	// Logs rules whose estimated cost in this window just went over ProfileBudgetMs, and slow or
+	// inefficient rules the profiler found, once each
+	void ReportFlaggedRules() {
+		const std::vector<ConfigEntry>* sections[] = { &buyPriceEntries, &sellPriceEntries, &countEntries };
+		for (auto&& [k, i] : profiler.TakeFlagged()) {
+			if (i >= sections[k]->size()) continue;  // benchmark sections
+			const auto& rule = profiler.Rules(k)[i];
+			logger::warn("{}: entry {} has cost an estimated {:.1f} ms since the last reset, over the {:.1f} ms budget ({} samples, {:.0f} ns per evaluation)",
+				kSectionNames[k], (*sections[k])[i].Origin(), profiler.EstimatedNs(rule) / 1e6, profiler.BudgetMs(), rule.samples, profiler.MeanNs(rule));
+		}
+		for (const auto& suspect : profiler.TakeSuspects()) {
+			const auto k = suspect.section;
+			const auto i = suspect.entry;
+			if (i >= sections[k]->size()) continue;
+			const auto& rule = profiler.Rules(k)[i];
+			if (suspect.finding == RuleProfiler::Finding::Slow) {
+				logger::warn("{}: entry {} is slow, {:.0f} ns per evaluation against {:.0f} ns for the average entry of the section. {}",
+					kSectionNames[k], (*sections[k])[i].Origin(), profiler.MeanNs(rule), profiler.SectionMeanNs(k), SuggestOrder(k, i));
+			} else {
+				logger::warn("{}: entry {} costs {:.0f} ns per evaluation ({:.0f} ns for the average entry) and matched {:.1f}% of its sampled evaluations. {}",
+					kSectionNames[k], (*sections[k])[i].Origin(), profiler.MeanNs(rule), profiler.SectionMeanNs(k), 100.0 * profiler.MatchRate(rule), SuggestOrder(k, i));
+			}
+		}
+	}
+
+	// Checks of an entry in compiled order and in the order of their learned cost per rejection,
+	// cheapest and most selective first, so the author can see which filter does the rejecting
+	std::string SuggestOrder(size_t k, size_t i) const {
+		const SectionKernel* kernels[] = { &buyKernel, &sellKernel, &countKernel };
+		const auto& section = *kernels[k];
+		std::vector<std::uint32_t> checks;
+		for (auto pc = section.entryStart[i]; section.program.code[pc].op != FilterVM::Op::Accept; ++pc) {
+			const auto id = section.program.group[pc];
+			if (id != PredicateStats::kNone && std::ranges::find(checks, id) == checks.end()) checks.push_back(id);
+		}
+		if (checks.empty()) return "Its cost is in its item filters; narrowing them (forms or keywords before weight/value ranges) is the only remedy.";
+
+		const double ticksPerNs = profiler.TicksPerNs();
+		auto describe = [&](std::uint32_t id) {
+			const auto& stats = predicateStats.Get(id);
+			if (stats.evaluations < PredicateStats::kMinSamples) return std::format("'{}' (not measured yet)", predicateStats.Signature(id));
+			return std::format("'{}' ({:.0f} ns, rejects {:.0f}%)", predicateStats.Signature(id),
+				stats.ticks / ticksPerNs / stats.evaluations, 100.0 * stats.rejections / stats.evaluations);
+		};
+
+		auto ranked = checks;
+		std::ranges::stable_sort(ranked, {}, [&](std::uint32_t id) { return predicateStats.Rank(id, 1e9); });
+		std::string current, suggested;
+		for (size_t n = 0; n < checks.size(); ++n) {
+			current += (n ? " -> " : "") + describe(checks[n]);
+			suggested += (n ? " -> " : "") + describe(ranked[n]);
+		}
+		if (ranked == checks) return std::format("Its checks already run cheapest-rejection first: {}. Consider a more selective item filter so they run less often.", current);
+		return std::format("Checks run as {}; suggested order {} (applied automatically after loading a save once statistics are learned).", current, suggested);
+	}
 
-				// Load count entries
-				if (configJson.contains("Counts")) {
-					logger::debug("Loading count entries from config");
-					for (size_t i = 0; i < configJson["Counts"].size(); ++i) {
-						logger::trace("Loading count entry {}", i + 1);
-						countEntries.emplace_back(configJson["Counts"][i]);
-					}
-					logger::info("Loaded {} count entries", countEntries.size());
+	void CompileAndJIT(SectionKernel& section, const std::vector<ConfigEntry>& entries, const char* name) {
+		CompileSection(section, entries, name);
+		for (const auto& in : section.program.code) {
+			if (in.op != FilterVM::Op::Memo) continue;
+			++compiledShared;
+			uniqueShared.insert(in.operand);
+		}
+		section.jit.reset();
+		if (settings.jit && entries.size() >= settings.jitMinEntries) {
+			section.jit = FilterJIT::Compile(section.program, section.entryStart);
+			if (section.jit) logger::info("JIT compiled {} {} entries to {} bytes", entries.size(), name, section.jit->getSize());
+		}
+	}
+
+	void ReportDedupe() {
+		logger::info("Predicate dedupe: {} merchant/player checks across all sections, {} unique ({:.1f}x)",
+			compiledShared, uniqueShared.size(), uniqueShared.empty() ? 1.0 : static_cast<double>(compiledShared) / uniqueShared.size());
+		compiledShared = 0;
+		uniqueShared.clear();
+		ResetSessionMemo();
+	}
+
+	// Canonical predicate set of every entry: the interned group IDs of its bytecode plus its Require ops.
+	// Filters within an entry are AND-ed, so A implies B whenever B's set is a subset of A's.
+	std::vector<std::vector<std::uint32_t>> EntryPredicates(const std::vector<ConfigEntry>& entries, const char* name) {
+		SectionKernel scratch;
+		size_t rows = 0;
+		for (const auto& entry : entries) {
+			scratch.rowBase.push_back(rows);
+			rows += entry.filters.itemFilters.size();
+		}
+		CompileSection(scratch, entries, name);
+
+		std::vector<std::vector<std::uint32_t>> predicates(entries.size());
+		for (size_t i = 0; i < entries.size(); ++i) {
+			auto& set = predicates[i];
+			for (auto pc = scratch.entryStart[i]; scratch.program.code[pc].op != FilterVM::Op::Accept; ++pc) {
+				auto stat = scratch.program.group[pc];
+				if (stat != PredicateStats::kNone) set.push_back(stat);
+				else set.push_back(PredicateStats::kNone - static_cast<std::uint32_t>(scratch.program.code[pc].op) - 1);
+			}
+			std::ranges::sort(set);
+			set.erase(std::unique(set.begin(), set.end()), set.end());
+		}
+		return predicates;
+	}
+
+	// Multiplies `from` into `into`, combining caps the same way matching count entries combine
+	static void FoldEntry(ConfigEntry& into, const ConfigEntry& from) {
+		into.value.min = into.value.max = into.value.min * from.value.min;
+		if (from.low_cap != CountStage::kNoCap) into.low_cap = into.low_cap == CountStage::kNoCap ? from.low_cap : std::max(into.low_cap, from.low_cap);
+		if (from.high_cap != CountStage::kNoCap) into.high_cap = into.high_cap == CountStage::kNoCap ? from.high_cap : std::min(into.high_cap, from.high_cap);
+	}
+
+	// Merges fixed-value entries with identical filter sets into the first of them, then folds every
+	// fixed-value entry implied by a stricter one into it. A folded entry still runs on its own, but is
+	// dropped whenever the stricter entry matched, as its multiplier is already part of that entry's.
+	void MergeEntries(SectionKernel& section, std::vector<ConfigEntry>& entries, const char* name) {
+		section.folds.clear();
+		if (entries.size() < 2) return;
+
+		auto predicates = EntryPredicates(entries, name);
+		std::vector<bool> removed(entries.size(), false);
+		std::map<std::vector<std::uint32_t>, size_t> firstWith;
+		size_t merged = 0;
+		for (size_t i = 0; i < entries.size(); ++i) {
+			if (entries[i].value.isRange) continue;
+			auto [it, inserted] = firstWith.try_emplace(predicates[i], i);
+			if (inserted) continue;
+			auto& into = entries[it->second];
+			logger::info("{}: merged entry {} into {} (identical filters), multiplier {} x {}", name, entries[i].Origin(), into.Origin(), into.value.min, entries[i].value.min);
+			FoldEntry(into, entries[i]);
+			removed[i] = true;
+			++merged;
+		}
+		if (merged) {
+			std::vector<ConfigEntry> kept;
+			std::vector<std::vector<std::uint32_t>> keptPredicates;
+			for (size_t i = 0; i < entries.size(); ++i) {
+				if (removed[i]) continue;
+				kept.push_back(std::move(entries[i]));
+				keptPredicates.push_back(std::move(predicates[i]));
+			}
+			entries = std::move(kept);
+			predicates = std::move(keptPredicates);
+		}
+
+		// Implied entries are visited before the entries implying them, so a fold always carries the full
+		// product of its own folds. Each entry folds into at most one other, or a match of two stricter
+		// entries would apply it twice. Static entries are applied from the folded table and stay as they are.
+		// Counts keep the rounding mode of the first matching entry, so only later entries fold there.
+		std::vector<size_t> order(entries.size());
+		std::iota(order.begin(), order.end(), size_t{ 0 });
+		std::ranges::stable_sort(order, {}, [&](size_t i) { return predicates[i].size(); });
+
+		const bool counts = &section == &countKernel;
+		std::vector<bool> folded(entries.size(), false);
+		for (size_t a : order) {
+			if (entries[a].value.isRange) continue;
+			for (size_t b : order) {
+				if (predicates[b].size() >= predicates[a].size()) break;
+				if (folded[b] || entries[b].value.isRange || IsStaticEntry(entries[b]) || (counts && b < a)) continue;
+				if (!std::ranges::includes(predicates[a], predicates[b])) continue;
+				logger::info("{}: folded entry {} into {} (implied filters), multiplier {} x {}", name, entries[b].Origin(), entries[a].Origin(), entries[a].value.min, entries[b].value.min);
+				FoldEntry(entries[a], entries[b]);
+				section.folds.emplace_back(a, b);
+				folded[b] = true;
+			}
+		}
+
+		if (merged || !section.folds.empty()) {
+			logger::info("{}: {} identical entries merged, {} implied entries folded, {} entries remain", name, merged, section.folds.size(), entries.size());
+		}
+	}
+
+	// Rolls a ranged entry once per item class and session, so a price stays the same while trading
+	float RolledValue(std::map<std::pair<int, std::uint64_t>, float>& cache, const ConfigEntry& entry, size_t i, RE::TESBoundObject* object) {
+		std::pair<int, std::uint64_t> rulePair(static_cast<int>(i), MemoKey(object));
+		auto it = cache.find(rulePair);
+		if (replayingRolls || it == cache.end()) return cache[rulePair] = Roll(0, i, entry);
+		if (capture.IsOpen() && entry.value.isRange) rolls.push_back({ 0, static_cast<std::uint16_t>(i), it->second });
+		return it->second;
+	}
+
+	// Value of entry i for stack `item` of the call: rolled and recorded while capturing, the recorded roll
+	// while replaying one
+	float Roll(std::uint32_t item, size_t i, const ConfigEntry& entry) {
+		if (!entry.value.isRange) return entry.value.min;
+		if (replayingRolls) {
+			for (const auto& roll : rolls) {
+				if (roll.item == item && roll.entry == i) return roll.value;
+			}
+			++unrecordedRolls;
+		}
+		const float value = entry.value.GetValue();
+		if (capture.IsOpen() && !replayingRolls) rolls.push_back({ item, static_cast<std::uint16_t>(i), value });
+		return value;
+	}
+
+	// Stacks of an inventory as the barter menu lists them: one per extra data list, plus the plain remainder
+	template <class Fn>
+	static void ForEachStack(RE::TESObjectREFR* ref, Fn&& capture) {
+		if (!ref) return;
+		for (auto&& [object, data] : ref->GetInventory()) {
+			auto&& [count, entry] = data;
+			if (!object || count <= 0 || !entry) continue;
+
+			std::int32_t plain = count;
+			if (entry->extraLists) {
+				for (auto xList : *entry->extraLists) {
+					if (!xList) continue;
+					RE::InventoryEntryData stack(object, 1);
+					stack.AddExtraList(xList);
+					capture(&stack);
+					plain -= xList->GetCount();
 				}
-				else {
-					logger::warn("No 'Counts' section found in config");
+			}
+			if (plain > 0) {
+				RE::InventoryEntryData stack(object, plain);
+				capture(&stack);
+			}
+		}
+	}
+
+	static void CaptureInventory(PriceTable& table, RE::TESObjectREFR* ref) {
+		ForEachStack(ref, [&](RE::InventoryEntryData* stack) {
+			table.Add(ValueCache::KeyOf(stack), { stack->object, stack->object->GetWeight(), static_cast<float>(ValueCache::getInstance()->Get(stack)) });
+		});
+	}
+
+	// Editor IDs of most base forms are only kept in memory by powerofthree's Tweaks
+	static std::string_view EditorIDOf(RE::TESForm* form) {
+		using _GetFormEditorID = const char* (*)(std::uint32_t);
+		static auto tweaks = GetModuleHandle(L"po3_Tweaks");
+		static auto GetFormEditorID = tweaks ? reinterpret_cast<_GetFormEditorID>(GetProcAddress(tweaks, "GetFormEditorID")) : nullptr;
+		const char* id = GetFormEditorID ? GetFormEditorID(form->GetFormID()) : form->GetFormEditorID();
+		return id ? id : "";
+	}
+
+	// Skills, perks and globals referenced by any compiled section, the state a capture record carries
+	void CollectCaptureInputs() {
+		captureInputs = {};
+		auto add = [](auto& list, auto value) {
+			if (std::ranges::find(list, value) == list.end()) list.push_back(value);
+		};
+		for (auto section : { &buyKernel, &sellKernel, &countKernel }) {
+			const auto& program = section->program;
+			for (const auto& in : program.code) {
+				if (in.op == FilterVM::Op::LoadSkill) add(captureInputs.skills, static_cast<std::uint16_t>(in.operand));
+				else if (in.op == FilterVM::Op::TestPerk) add(captureInputs.perks, program.pool[in.operand]->As<RE::BGSPerk>());
+				else if (in.op == FilterVM::Op::LoadGlobal) add(captureInputs.globals, program.pool[in.operand]->As<RE::TESGlobal>());
+			}
+		}
+	}
+
+	Capture::State CaptureState(RE::Actor* trader, RE::PlayerCharacter* player) const {
+		Capture::State state{ .trader = trader->GetFormID() };
+		state.traderBase = trader->GetBaseObject() ? trader->GetBaseObject()->GetFormID() : 0;
+		state.relationship = static_cast<float>(FilterVM::GetRelationshipRank(trader));
+		if (player) {
+			state.level = static_cast<float>(player->GetLevel());
+			auto av = player->AsActorValueOwner();
+			for (auto id : captureInputs.skills) {
+				state.skills.emplace_back(id, av ? av->GetActorValue(static_cast<RE::ActorValue>(id)) : std::numeric_limits<float>::quiet_NaN());
+			}
+			for (auto perk : captureInputs.perks) state.perks.emplace_back(perk->GetFormID(), player->HasPerk(perk));
+		}
+		for (auto global : captureInputs.globals) state.globals.emplace_back(global->GetFormID(), global->value);
+		return state;
+	}
+
+	// Buy, sell, count: the order of per-section arrays
+	size_t SectionIndex(const SectionKernel& section) const {
+		return &section == &buyKernel ? 0 : &section == &sellKernel ? 1 : 2;
+	}
+
+	// Entries whose merchant form filters accept `trader`. Those never change for an actor, so they are
+	// resolved once per trader and config; only the remaining entries run their merchant/player bytecode.
+	const RuleMask& TraderVerdicts(const SectionKernel& section, RE::Actor* trader) {
+		auto& verdicts = traderVerdicts[trader->GetFormID()];
+		const size_t k = SectionIndex(section);
+		if (verdicts[k].Size() == section.merchantForms.size() && verdicts[k].Size()) return verdicts[k];
+
+		const auto base = trader->GetBaseObject() ? trader->GetBaseObject()->GetFormID() : 0;
+		verdicts[k].Resize(section.merchantForms.size());
+		for (size_t i = 0; i < section.merchantForms.size(); ++i) {
+			if (std::ranges::all_of(section.merchantForms[i], [&](RE::FormID form) { return form && (form == trader->GetFormID() || form == base); })) {
+				verdicts[k].Set(i);
+			}
+		}
+		return verdicts[k];
+	}
+
+	// Settles merchant/player filters and captures both sides on the main thread, the only part that needs
+	// the engine, then matches every captured stack against the item filters on a worker thread
+	void StartPriceTables(RE::Actor* trader, RE::PlayerCharacter* player) {
+		StopPriceTables();
+		Trace::Span span("CapturePriceTables", "session");
+		const auto start = std::chrono::steady_clock::now();
+
+		gameState.Reset();
+		FilterVM::Context actors{ nullptr, trader, player, nullptr, MemoFor(trader), &gameState };
+		auto eligibleIn = [&](const SectionKernel& section) {
+			RuleMask eligible(section.actorStart.size());
+			TraderVerdicts(section, trader).ForEach([&](size_t i) {
+				if (FilterVM::Run(section.program, section.actorStart[i], actors)) eligible.Set(i);
+			});
+			return eligible;
+		};
+
+		priceEligible[0] = eligibleIn(buyKernel);
+		priceEligible[1] = eligibleIn(sellKernel);
+
+		buyTable = std::make_shared<PriceTable>(trader->GetFormID());
+		sellTable = std::make_shared<PriceTable>(trader->GetFormID());
+		if (auto faction = trader->GetVendorFaction()) CaptureInventory(*buyTable, faction->vendorData.merchantContainer);
+		CaptureInventory(*buyTable, trader);
+		CaptureInventory(*sellTable, player);
+		buyTable->Seal();
+		sellTable->Seal();
+
+		priceCaptured = std::chrono::steady_clock::now();
+		logger::info("Barter menu open: captured {} merchant and {} player stacks in {:.3f} ms on the main thread",
+			buyTable->Size(), sellTable->Size(), std::chrono::duration<double, std::milli>(priceCaptured - start).count());
+
+		// Both sides at high priority, ahead of any load-time work still queued
+		for (size_t k = 0; k < 2; ++k) {
+			Pool().Submit(priceJob, ThreadPool::Priority::High, [this, table = k ? sellTable : buyTable, k]() {
+				FillPriceTable(*table, k ? sellKernel : buyKernel, k ? sellPriceEntries : buyPriceEntries, priceEligible[k]);
+				logger::info("Priced {} {} stacks on a worker thread in {:.3f} ms{}", table->Size(), k ? "player" : "merchant",
+					std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - priceCaptured).count(), table->Cancelled() ? " (cancelled)" : "");
+			});
+		}
+	}
+
+	// Worker side: item filters only, from the captured attributes and the load-time tables
+	void FillPriceTable(PriceTable& table, const SectionKernel& section, const std::vector<ConfigEntry>& entries, const RuleMask& eligible) const {
+		Trace::Span span("FillPriceTable", "session", static_cast<std::uint32_t>(table.Size()));
+		RuleMask rows;
+		for (size_t n = 0; n < table.Size() && !table.Cancelled(); ++n) {
+			const auto& item = table.At(n);
+			section.kernel.Evaluate(item.weight, section.kernel.HasValueColumn() ? item.value : 0.0f, rows);
+			ApplyStaticRows(section, item.object, rows);
+
+			PriceTable::Price price;
+			const auto* candidates = &section.allEntries;
+			if (section.dynamicEntries.size() != section.allEntries.size()) {
+				if (auto folded = section.staticTable.Lookup(item.object->GetFormID())) {
+					price.fixed = *folded;
+					candidates = &section.dynamicEntries;
 				}
+			}
 
-				logger::info("Configuration loaded successfully - {} buy price entries, {} sell price entries, and {} count entries",
-					buyPriceEntries.size(), sellPriceEntries.size(), countEntries.size());
+			RuleMask matched(entries.size());
+			for (size_t i : *candidates) {
+				if (eligible.Test(i) && rows.Contains(section.ruleRows[i])) matched.Set(i);
 			}
-			return true;
+			SuppressFolded(section, matched);
+			Telemetry::getInstance()->RecordRules(SectionIndex(section), *candidates, matched);  // once per stack, not per price shown
+
+			price.ranged.Resize(entries.size());
+			matched.ForEach([&](size_t i) {
+				if (entries[i].value.isRange) price.ranged.Set(i);
+				else price.fixed *= entries[i].value.min;
+			});
+			table.Publish(n, std::move(price));
+		}
+	}
 
+	void StopPriceTables() {
+		if (buyTable) buyTable->Cancel();
+		if (sellTable) sellTable->Cancel();
+		if (pool) priceJob.Wait(*pool);
+		buyTable.reset();
+		sellTable.reset();
+	}
+
+	const PriceTable::Price* FindPrice(const std::shared_ptr<PriceTable>& table, RE::Actor* trader, RE::InventoryEntryData* item) {
+		if (!table || !item || !item->object || table->Trader() != trader->GetFormID()) return nullptr;
+		auto price = table->Find(ValueCache::KeyOf(item));
+		++(price ? servedFromTable : servedInline);
+		Telemetry::getInstance()->RecordCache(Telemetry::Cache::PriceTable, price != nullptr);
+		return price;
+	}
+
+	// Drops folded entries whose multiplier was applied by a matching stricter entry
+	static void SuppressFolded(const SectionKernel& section, RuleMask& matched) {
+		for (auto&& [into, from] : section.folds) {
+			if (matched.Test(into)) matched.Reset(from);
+		}
+	}
+
+	void BuildKernels() {
+		Trace::Span span("BuildKernels", "load");
+		traderVerdicts.clear();
+		KeywordIndex::getInstance()->Clear();
+		{
+			Trace::Span phase("MergeEntries", "load");
+			MergeEntries(buyKernel, buyPriceEntries, "BuyPrices");
+			MergeEntries(sellKernel, sellPriceEntries, "SellPrices");
+			MergeEntries(countKernel, countEntries, "Counts");
+		}
+		{
+			Trace::Span phase("BuildKernel", "load");
+			BuildKernel(buyKernel, buyPriceEntries, "BuyPrices");
+			BuildKernel(sellKernel, sellPriceEntries, "SellPrices");
+			BuildKernel(countKernel, countEntries, "Counts");
+			ReportDedupe();
+		}
+		{
+			Trace::Span phase("KeywordIndex", "load");
+			KeywordIndex::getInstance()->Build();
+		}
+		{
+			Trace::Span phase("BuildItemClasses", "load");
+			BuildItemClasses();
+		}
+		{
+			Trace::Span phase("BuildStaticTable", "load");
+			BuildStaticTable(buyKernel, buyPriceEntries, "BuyPrices");
+			BuildStaticTable(sellKernel, sellPriceEntries, "SellPrices");
+		}
+	}
+
+	// Keyword/form/weight filters only, fixed value, no merchant or player section
+	static bool IsStaticEntry(const ConfigEntry& entry) {
+		if (entry.value.isRange || !entry.filters.merchantFilters.empty() || !entry.filters.playerFilters.empty()) return false;
+		return std::ranges::all_of(entry.filters.itemFilters, [](const ItemFilter& filter) {
+			return filter.valueFilter.type == ComparisonFilter::NONE;
+		});
+	}
+
+	// Folds the product of all static entries into a FormID-indexed table, one value per item class
+	void BuildStaticTable(SectionKernel& section, const std::vector<ConfigEntry>& entries, const char* name) {
+		section.staticTable.Clear();
+		section.dynamicEntries.clear();
+
+		std::vector<size_t> staticEntries;
+		for (size_t i = 0; i < entries.size(); ++i) {
+			if (IsStaticEntry(entries[i])) staticEntries.push_back(i);
+			else section.dynamicEntries.push_back(i);
+		}
+		if (staticEntries.empty()) {
+			logger::debug("{}: no fully static entries to fold", name);
+			return;
+		}
+
+		std::vector<float> classProduct(section.classRows.size(), 1.0f);
+		for (size_t c = 0; c < classProduct.size(); ++c) {
+			for (size_t i : staticEntries) {
+				if (section.classRows[c].Contains(section.ruleRows[i])) classProduct[c] *= entries[i].value.min;
+			}
+		}
+		for (auto&& [formID, classID] : formClass) section.staticTable.Insert(formID, classProduct[classID]);
+		section.staticTable.Finalize();
+
+		logger::info("{}: folded {} static entries into a table of {} forms with {} distinct products ({} KiB), {} dynamic entries remain",
+			name, staticEntries.size(), section.staticTable.Forms(), section.staticTable.Products(),
+			section.staticTable.Bytes() / 1024, section.dynamicEntries.size());
+	}
+
+	std::optional<float> LookupStatic(const SectionKernel& section, RE::InventoryEntryData* item) const {
+		if (!item || !item->object || section.dynamicEntries.size() == section.allEntries.size()) return std::nullopt;
+		return section.staticTable.Lookup(item->object->GetFormID());
+	}
+
+	// Static row results of a base form: form and weight never change at runtime. Keywords can (scripts,
+	// KID at load), so the results are only as current as the keyword masks they were built from.
+	// Takes what it needs already read off the form, so it is safe on the workers
+	void StaticRows(const SectionKernel& section, RE::FormID formID, float weight, const std::uint64_t* keywords, RuleMask& out) const {
+		section.kernel.EvaluateWeight(weight, out);
+		out.ForEach([&](size_t r) {
+			if (!section.resolved[r].Matches(formID, keywords)) out.Reset(r);
+		});
+	}
+
+	static constexpr size_t kFormGrain = 512;  // forms per worker task
+	static constexpr const char* kSectionNames[] = { "BuyPrices", "SellPrices", "Counts" };
+
+	// Groups every tradeable base form by its static row results across all three sections,
+	// so static matches and rolled multipliers are memoized per class instead of per FormID
+	void BuildItemClasses() {
+		formClass.clear();
+		std::unordered_map<std::string, std::uint32_t> signatures;
+		SectionKernel* sections[] = { &buyKernel, &sellKernel, &countKernel };
+
+		// Weights and keyword masks are read here on the main thread, the workers only see the copies
+		const size_t words = KeywordIndex::getInstance()->Words();
+		std::vector<RE::FormID> ids;
+		std::vector<float> weights;
+		std::vector<std::uint64_t> keywords;
+		ForEachTradeableForm([&](RE::TESBoundObject* object) {
+			ids.push_back(object->GetFormID());
+			weights.push_back(object->GetWeight());
+			const auto* mask = KeywordIndex::getInstance()->Mask(object);
+			keywords.insert(keywords.end(), mask, mask + words);
+		});
+
+		// Signatures per form on the workers, classes assigned in form order afterwards
+		auto signatureOf = [&](size_t n, RuleMask (&rows)[3]) {
+			std::string signature;
+			for (size_t k = 0; k < 3; ++k) {
+				StaticRows(*sections[k], ids[n], weights[n], keywords.data() + n * words, rows[k]);
+				signature.append(reinterpret_cast<const char*>(rows[k].Data()), rows[k].WordCount() * sizeof(std::uint64_t));
+			}
+			return signature;
+		};
+		std::vector<std::string> formSignatures(ids.size());
+		Pool().ParallelFor(0, ids.size(), kFormGrain, [&](size_t n) {
+			RuleMask rows[3];
+			formSignatures[n] = signatureOf(n, rows);
+		});
+
+		RuleMask rows[3];
+		for (size_t n = 0; n < ids.size(); ++n) {
+			auto [it, inserted] = signatures.try_emplace(std::move(formSignatures[n]), static_cast<std::uint32_t>(signatures.size()));
+			if (inserted) {
+				signatureOf(n, rows);
+				for (size_t k = 0; k < 3; ++k) sections[k]->classRows.push_back(rows[k]);
+			}
+			formClass[ids[n]] = it->second;
+		}
+
+		size_t maskBytes = 0;
+		for (auto section : sections) maskBytes += sizeof(RuleMask) + section->kernel.Rows() / 8 + sizeof(std::uint64_t);
+		size_t perForm = formClass.size() * (sizeof(RE::FormID) + maskBytes);
+		size_t perClass = signatures.size() * maskBytes + formClass.size() * (sizeof(RE::FormID) + sizeof(std::uint32_t));
+		logger::info("Grouped {} tradeable forms into {} item classes, static match memo {} KiB instead of {} KiB per form ({} KiB saved)",
+			formClass.size(), signatures.size(), perClass / 1024, perForm / 1024, perForm > perClass ? (perForm - perClass) / 1024 : 0);
+	}
+
+	// Rolled multipliers are cached per item class; forms created at runtime fall back to their FormID
+	std::uint64_t MemoKey(RE::TESBoundObject* object) const {
+		if (auto it = formClass.find(object->GetFormID()); it != formClass.end()) return (1ull << 32) | it->second;
+		return object->GetFormID();
+	}
+
+	// Masks kernel results with the form/keyword/weight results of the item's class
+	void ApplyStaticRows(const SectionKernel& section, RE::TESBoundObject* object, RuleMask& rows) const {
+		if (auto it = formClass.find(object->GetFormID()); it != formClass.end() && it->second < section.classRows.size()) {
+			rows &= section.classRows[it->second];
+			return;
+		}
+		const auto* keywords = KeywordIndex::getInstance()->Mask(object);
+		rows.ForEach([&](size_t r) {
+			if (!section.resolved[r].Matches(object, keywords)) rows.Reset(r);
+		});
+	}
+
+	// Evaluates every item filter row of a section against the item at once
+	void EvaluateItemRows(const SectionKernel& section, RE::InventoryEntryData* item, RuleMask& out) {
+		if (!item || !item->object) {
+			out.Resize(section.kernel.Rows());
+			return;
+		}
+		float weight = item->object->GetWeight();
+		float value = section.kernel.HasValueColumn() ? static_cast<float>(ValueCache::getInstance()->Get(item)) : 0.0f;
+		section.kernel.Evaluate(weight, value, out);
+		ApplyStaticRows(section, item->object, out);
+	}
+
+	// A file that fails to open, parse or build its entries is logged and skipped; the kernels are built for
+	// every file that did load, so one bad file never leaves the others inactive
+	bool LoadConfig(const std::string& path) {
+		std::vector<std::filesystem::directory_entry> files;
+		try {
+			files.assign(std::filesystem::directory_iterator(path), {});
 		} catch (const std::exception& e) {
 			logger::error("Error loading config: {}", e.what());
-			return false;
+		}
+		bool loaded = !files.empty();
+
+		// Files are parsed in parallel; entries are still built in directory order below
+		std::vector<nlohmann::json> documents(files.size());
+		std::vector<std::string> errors(files.size());
+		Pool().ParallelFor(0, files.size(), 1, [&](size_t n) {
+			std::ifstream file(files[n].path());
+			if (!file.is_open()) {
+				errors[n] = "Failed to open config file";
+				return;
+			}
+			try {
+				file >> documents[n];
+			} catch (const std::exception& e) {
+				errors[n] = e.what();
+			}
+		});
+
+		for (size_t n = 0; n < files.size(); ++n) {
+			const auto& file_ = files[n];
+			logger::info("Loading configuration from: {}", file_.path().string());
+
+			if (!errors[n].empty()) {
+				logger::error("Skipping config file {}: {}", file_.path().string(), errors[n]);
+				loaded = false;
+				continue;
+			}
+			logger::debug("Successfully parsed JSON from config file");
+
+			// Entries of a file are kept whole or not at all
+			const size_t buys = buyPriceEntries.size(), sells = sellPriceEntries.size(), counts = countEntries.size();
+			try {
+				LoadEntries(documents[n], file_.path().filename().string());
+			} catch (const std::exception& e) {
+				logger::error("Skipping config file {}: {}", file_.path().string(), e.what());
+				buyPriceEntries.erase(buyPriceEntries.begin() + buys, buyPriceEntries.end());
+				sellPriceEntries.erase(sellPriceEntries.begin() + sells, sellPriceEntries.end());
+				countEntries.erase(countEntries.begin() + counts, countEntries.end());
+				loaded = false;
+				continue;
+			}
+
+			logger::info("Configuration loaded successfully - {} buy price entries, {} sell price entries, and {} count entries",
+				buyPriceEntries.size(), sellPriceEntries.size(), countEntries.size());
+		}
+		Scheduler::getInstance()->SetBudget(settings.frameBudgetMs);
+		ResizePool();
+		Trace::getInstance()->Enable(settings.traceEvents);  // after parsing, as the setting comes from the files
+		BuildKernels();
+		Telemetry::getInstance()->Configure({ buyPriceEntries.size(), sellPriceEntries.size(), countEntries.size() });
+		profiler.Configure(settings.profileRuleEvery, settings.profileCallEvery, settings.profileBudgetMs,
+			{ buyPriceEntries.size(), sellPriceEntries.size(), countEntries.size() });
+		if (capture.IsOpen()) CollectCaptureInputs();
+		ReportPool("Config load");
+		return loaded;
+	}
+
+	// Engine settings and the entries of one parsed config file
+	void LoadEntries(nlohmann::json& configJson, const std::string& source) {
+		if (configJson.contains("Engine")) {
+			settings.Parse(configJson["Engine"]);
+		}
+
+		// Load buy price entries
+		if (configJson.contains("BuyPrices")) {
+			logger::debug("Loading buy price entries from config");
+			for (size_t i = 0; i < configJson["BuyPrices"].size(); ++i) {
+				logger::trace("Loading buy price entry {}", i + 1);
+				auto& entry = buyPriceEntries.emplace_back(configJson["BuyPrices"][i]);
+				entry.source = source;
+				entry.index = i;
+			}
+			logger::info("Loaded {} buy price entries", buyPriceEntries.size());
+		}
+		else {
+			logger::warn("No 'BuyPrices' section found in config");
+		}
+
+		// Load sell price entries
+		if (configJson.contains("SellPrices")) {
+			logger::debug("Loading sell price entries from config");
+			for (size_t i = 0; i < configJson["SellPrices"].size(); ++i) {
+				logger::trace("Loading sell price entry {}", i + 1);
+				auto& entry = sellPriceEntries.emplace_back(configJson["SellPrices"][i]);
+				entry.source = source;
+				entry.index = i;
+			}
+			logger::info("Loaded {} sell price entries", sellPriceEntries.size());
+		}
+		else {
+			logger::warn("No 'SellPrices' section found in config");
+		}
+
+		// Load count entries
+		if (configJson.contains("Counts")) {
+			logger::debug("Loading count entries from config");
+			for (size_t i = 0; i < configJson["Counts"].size(); ++i) {
+				logger::trace("Loading count entry {}", i + 1);
+				auto& entry = countEntries.emplace_back(configJson["Counts"][i]);
+				entry.source = source;
+				entry.index = i;
+			}
+			logger::info("Loaded {} count entries", countEntries.size());
+		}
+		else {
+			logger::warn("No 'Counts' section found in config");
 		}
 	}
 
-	bool MatchesFilters(const FilterSet& filters, RE::Actor* trader, RE::InventoryEntryData* item, RE::PlayerCharacter* player) {
+	// Reference evaluator the bytecode was compiled from.
+	// rowMask/rowBase carry the precomputed item filter results of the section, if any
+	bool MatchesFilters(const FilterSet& filters, RE::Actor* trader, RE::InventoryEntryData* item, RE::PlayerCharacter* player,
+		const RuleMask* rowMask = nullptr, size_t rowBase = 0) {
 		logger::trace("Checking filter matches - Item filters: {}, Merchant filters: {}, Player filters: {}", 
 					filters.itemFilters.size(), filters.merchantFilters.size(), filters.playerFilters.size());
 		
@@ -609,7 +2247,7 @@ private:
 			for (size_t i = 0; i < filters.itemFilters.size(); ++i) {
 				const auto& itemFilter = filters.itemFilters[i];
 				logger::trace("Checking item filter {}", i + 1);
-				if (MatchesItemFilter(itemFilter, item)) {
+				if (MatchesItemFilter(itemFilter, item, rowMask, rowBase + i)) {
 					logger::debug("Item filter {} matched", i + 1);
 					continue;
 				}
@@ -621,6 +2259,15 @@ private:
 			return false;
 		}
 
+		if (!MatchesMerchantSection(filters, trader) || !MatchesPlayerSection(filters, player)) {
+			return false;
+		}
+
+		logger::debug("All filter checks passed, accepting");
+		return true;
+	}
+
+	bool MatchesMerchantSection(const FilterSet& filters, RE::Actor* trader) {
 		// Check merchant filters (OR condition between filters)
 		if (!filters.merchantFilters.empty() && trader) {
 			logger::trace("Checking {} merchant filters", filters.merchantFilters.size());
@@ -638,7 +2285,10 @@ private:
 			logger::debug("Merchant filters present but no trader provided, rejecting");
 			return false;
 		}
+		return true;
+	}
 
+	bool MatchesPlayerSection(const FilterSet& filters, RE::PlayerCharacter* player) {
 		// Check player filters (OR condition between filters)
 		if (!filters.playerFilters.empty() && player) {
 			logger::trace("Checking {} player filters", filters.playerFilters.size());
@@ -656,17 +2306,21 @@ private:
 			logger::debug("Player filters present but no player provided, rejecting");
 			return false;
 		}
-
-		logger::debug("All filter checks passed, accepting");
 		return true;
 	}
 
-	bool MatchesItemFilter(const ItemFilter& filter, RE::InventoryEntryData* item) {
+	bool MatchesItemFilter(const ItemFilter& filter, RE::InventoryEntryData* item, const RuleMask* rowMask = nullptr, size_t row = 0) {
 		if (!item || !item->object) {
 			logger::trace("Item filter check failed: null item or object");
 			return false;
 		}
 
+		// Already evaluated by EvaluateItemRows
+		if (rowMask) {
+			logger::trace("Item filter row {}: {}", row, rowMask->Test(row));
+			return rowMask->Test(row);
+		}
+
 		logger::trace("Checking item filter - Form: '{}', Keyword: '{}'", 
 					filter.formEditorID, filter.keywordEditorID);
 
@@ -684,7 +2338,10 @@ private:
 		// Check keyword
 		if (!filter.keywordEditorID.empty()) {
 			auto keyword = RE::TESForm::LookupByEditorID<RE::BGSKeyword>(filter.keywordEditorID);
-			if (!keyword || !item->object->HasKeywordInArray({ keyword }, false)) {
+			auto index = KeywordIndex::getInstance()->Find(keyword);
+			bool hasKeyword = index != KeywordIndex::kNone ? KeywordIndex::getInstance()->Test(item->object, index)
+			                                                : keyword && item->object->HasKeywordInArray({ keyword }, false);
+			if (!keyword || !hasKeyword) {
 				logger::trace("Item keyword '{}' not found", filter.keywordEditorID);
 				return false;
 			}
@@ -704,7 +2361,7 @@ private:
 
 		// Check value
 		if (filter.valueFilter.type != ComparisonFilter::NONE) {
-			int value = item->GetValue();
+			int value = ValueCache::getInstance()->Get(item);
 			logger::trace("Checking item value: {}", value);
 			if (!filter.valueFilter.Matches(static_cast<float>(value))) {
 				logger::trace("Item value filter failed");
@@ -742,10 +2399,7 @@ private:
 			auto&& player = RE::PlayerCharacter::GetSingleton()->GetActorBase();
 			auto&& npc = trader->GetActorBase();
 
-			static REL::Relocation<int(*)(RE::TESNPC*, RE::TESNPC*)> getidx(RELOCATION_ID(24076, 24076));
-			static REL::Relocation<int*> idxmap(RELOCATION_ID(369311, 369311));
-
-			int relationshipLevel = idxmap.get()[getidx(player, npc)];
+			int relationshipLevel = RelationshipCache::getInstance()->Get(player, npc);
 			logger::trace("Checking merchant relationship level: {}", relationshipLevel);
 			if (!filter.relationship.Matches(relationshipLevel)) {
 				logger::trace("Merchant relationship filter failed");
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Binary capture of the inputs and results of the plugin's entry points, replayable through the engine.
+// Game-independent on purpose: a tool outside the game can read a capture with this header alone.
+//
+// Layout, little-endian, no padding:
+//   header  "SCCAPTUR" u32 version u32 reserved
+//   record  u8 kind, u8 flags, u16 reserved, u32 payload bytes, payload
+//   payload State, then Price or Restock, then the rolls of their ranged entries (see Write/Read below for field order)
+// Unknown kinds are skipped by their length, so readers of this version survive later additions.
+namespace Capture {
+	inline constexpr char kMagic[8] = { 'S', 'C', 'C', 'A', 'P', 'T', 'U', 'R' };
+	inline constexpr std::uint32_t kVersion = 2;
+
+	enum class Kind : std::uint8_t { Price = 1, Restock = 2 };
+	enum Flags : std::uint8_t { kBuying = 1 };
+
+	// Merchant and player state the config reads, and every global it references
+	struct State {
+		std::uint32_t trader = 0;      // reference FormID
+		std::uint32_t traderBase = 0;
+		float relationship = 0.0f;
+		float level = 0.0f;
+		std::vector<std::pair<std::uint16_t, float>> skills;      // actor value, value
+		std::vector<std::pair<std::uint32_t, std::uint8_t>> perks; // perk FormID, has
+		std::vector<std::pair<std::uint32_t, float>> globals;      // global FormID, value
+	};
+
+	struct Item {
+		std::uint32_t form = 0;
+		std::int32_t count = 0;   // restock: countDelta before the multipliers
+		std::int32_t value = 0;   // GetValue() of the stack
+		float weight = 0.0f;
+		std::int32_t result = 0;  // restock: countDelta after the multipliers
+	};
+	inline constexpr size_t kItemBytes = 20;  // an Item as written by PutItem
+
+	// Value a ranged entry rolled during the call, so a replay multiplies by the same one
+	struct Roll {
+		std::uint32_t item = 0;   // restock: index of the stack in Restock::items; price: 0
+		std::uint16_t entry = 0;  // index of the entry in its section
+		float value = 0.0f;
+	};
+	inline constexpr size_t kRollBytes = 10;  // a Roll as written by PutRolls
+
+	struct Price {
+		State state;
+		Item item;
+		bool buying = false;
+		float multiplier = 1.0f;
+		std::vector<Roll> rolls;
+	};
+
+	struct Restock {
+		State state;
+		std::uint32_t owner = 0;  // container reference
+		std::vector<Item> items;
+		std::vector<Roll> rolls;
+	};
+
+	class Buffer {
+	public:
+		template <class T>
+		void Put(const T& value) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			const auto* bytes = reinterpret_cast<const char*>(&value);
+			data.insert(data.end(), bytes, bytes + sizeof(T));
+		}
+
+		template <class A, class B>
+		void PutPairs(const std::vector<std::pair<A, B>>& pairs) {
+			Put(static_cast<std::uint16_t>(pairs.size()));
+			for (auto&& [a, b] : pairs) {
+				Put(a);
+				Put(b);
+			}
+		}
+
+		void PutState(const State& state) {
+			Put(state.trader);
+			Put(state.traderBase);
+			Put(state.relationship);
+			Put(state.level);
+			PutPairs(state.skills);
+			PutPairs(state.perks);
+			PutPairs(state.globals);
+		}
+
+		void PutItem(const Item& item) {
+			Put(item.form);
+			Put(item.count);
+			Put(item.value);
+			Put(item.weight);
+			Put(item.result);
+		}
+
+		void PutRolls(const std::vector<Roll>& rolls) {
+			Put(static_cast<std::uint32_t>(rolls.size()));
+			for (const auto& roll : rolls) {
+				Put(roll.item);
+				Put(roll.entry);
+				Put(roll.value);
+			}
+		}
+
+		std::vector<char> data;
+	};
+
+	class Reader {
+	public:
+		Reader(const char* begin, const char* end) : at(begin), end(end) {}
+
+		template <class T>
+		bool Get(T& value) {
+			if (static_cast<size_t>(end - at) < sizeof(T)) return false;
+			std::memcpy(&value, at, sizeof(T));
+			at += sizeof(T);
+			return true;
+		}
+
+		// The next `bytes` in place, null when fewer are left
+		const char* Take(size_t bytes) {
+			if (Remaining() < bytes) return nullptr;
+			const char* block = at;
+			at += bytes;
+			return block;
+		}
+
+		size_t Remaining() const { return static_cast<size_t>(end - at); }
+
+		// Counts come from the file, so they are checked against the bytes left before anything is sized by them
+		template <class A, class B>
+		bool GetPairs(std::vector<std::pair<A, B>>& pairs) {
+			std::uint16_t n = 0;
+			if (!Get(n) || n > Remaining() / (sizeof(A) + sizeof(B))) return false;
+			pairs.resize(n);
+			for (auto& [a, b] : pairs) {
+				if (!Get(a) || !Get(b)) return false;
+			}
+			return true;
+		}
+
+		bool GetState(State& state) {
+			return Get(state.trader) && Get(state.traderBase) && Get(state.relationship) && Get(state.level) &&
+			       GetPairs(state.skills) && GetPairs(state.perks) && GetPairs(state.globals);
+		}
+
+		bool GetItems(std::vector<Item>& items) {
+			std::uint32_t n = 0;
+			if (!Get(n) || n > Remaining() / kItemBytes) return false;
+			items.resize(n);
+			for (auto& item : items) {
+				if (!GetItem(item)) return false;
+			}
+			return true;
+		}
+
+		bool GetItem(Item& item) {
+			return Get(item.form) && Get(item.count) && Get(item.value) && Get(item.weight) && Get(item.result);
+		}
+
+		bool GetRolls(std::vector<Roll>& rolls) {
+			std::uint32_t n = 0;
+			if (!Get(n) || n > Remaining() / kRollBytes) return false;
+			rolls.resize(n);
+			for (auto& roll : rolls) {
+				if (!Get(roll.item) || !Get(roll.entry) || !Get(roll.value)) return false;
+			}
+			return true;
+		}
+
+	private:
+		const char* at;
+		const char* end;
+	};
+
+	// Appends records to a capture file; every record is flushed as a whole
+	class Writer {
+	public:
+		bool Open(const std::filesystem::path& path) {
+			file.open(path, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) return false;
+			file.write(kMagic, sizeof(kMagic));
+			const std::uint32_t header[2] = { kVersion, 0 };
+			file.write(reinterpret_cast<const char*>(header), sizeof(header));
+			records = 0;
+			return true;
+		}
+
+		bool IsOpen() const { return file.is_open(); }
+		std::uint64_t Records() const { return records; }
+
+		void Close() {
+			if (file.is_open()) file.close();
+		}
+
+		void Write(const Price& price) {
+			Buffer payload;
+			payload.PutState(price.state);
+			payload.PutItem(price.item);
+			payload.Put(price.multiplier);
+			payload.PutRolls(price.rolls);
+			Append(Kind::Price, price.buying ? kBuying : 0, payload);
+		}
+
+		void Write(const Restock& restock) {
+			Buffer payload;
+			payload.PutState(restock.state);
+			payload.Put(restock.owner);
+			payload.Put(static_cast<std::uint32_t>(restock.items.size()));
+			for (const auto& item : restock.items) payload.PutItem(item);
+			payload.PutRolls(restock.rolls);
+			Append(Kind::Restock, 0, payload);
+		}
+
+	private:
+		void Append(Kind kind, std::uint8_t flags, const Buffer& payload) {
+			const std::uint8_t head[4] = { static_cast<std::uint8_t>(kind), flags, 0, 0 };
+			const auto size = static_cast<std::uint32_t>(payload.data.size());
+			file.write(reinterpret_cast<const char*>(head), sizeof(head));
+			file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+			file.write(payload.data.data(), payload.data.size());
+			file.flush();
+			++records;
+		}
+
+		std::ofstream file;
+		std::uint64_t records = 0;
+	};
+
+	// Whole capture file, decoded record by record
+	class File {
+	public:
+		// Empty on a missing file, a foreign file or another version
+		static std::optional<File> Load(const std::filesystem::path& path) {
+			std::ifstream in(path, std::ios::binary | std::ios::ate);
+			if (!in.is_open()) return std::nullopt;
+			File file;
+			file.bytes.resize(static_cast<size_t>(in.tellg()));
+			in.seekg(0);
+			if (!in.read(file.bytes.data(), static_cast<std::streamsize>(file.bytes.size()))) return std::nullopt;
+			std::uint32_t version = 0;
+			if (file.bytes.size() < 16 || std::memcmp(file.bytes.data(), kMagic, sizeof(kMagic)) != 0) return std::nullopt;
+			std::memcpy(&version, file.bytes.data() + 8, sizeof(version));
+			if (version != kVersion) return std::nullopt;
+			return file;
+		}
+
+		// Calls onPrice(const Price&) or onRestock(const Restock&) per record; false on a truncated or
+		// corrupt file, after the records before the damage
+		template <class OnPrice, class OnRestock>
+		bool ForEach(OnPrice&& onPrice, OnRestock&& onRestock) const {
+			Reader reader(bytes.data() + 16, bytes.data() + bytes.size());
+			for (;;) {
+				std::uint8_t head[4];
+				std::uint32_t size = 0;
+				if (!reader.Get(head)) return true;
+				if (!reader.Get(size)) return false;
+
+				const char* payload = reader.Take(size);
+				if (!payload) return false;
+				Reader record(payload, payload + size);
+				switch (static_cast<Kind>(head[0])) {
+				case Kind::Price: {
+					Price price;
+					price.buying = head[1] & kBuying;
+					if (!record.GetState(price.state) || !record.GetItem(price.item) || !record.Get(price.multiplier) || !record.GetRolls(price.rolls)) return false;
+					onPrice(price);
+					break;
+				}
+				case Kind::Restock: {
+					Restock restock;
+					if (!record.GetState(restock.state) || !record.Get(restock.owner) || !record.GetItems(restock.items) || !record.GetRolls(restock.rolls)) return false;
+					onRestock(restock);
+					break;
+				}
+				default:
+					break;
+				}
+			}
+		}
+
+	private:
+		std::vector<char> bytes;
+	};
+}
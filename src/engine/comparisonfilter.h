@@ -0,0 +1,97 @@
+#pragma once
+
+#include "comparisonkernel.h"
+
+#include <cstdint>
+#include <string>
+
+// Structure for comparison operations (>, <, =, >=, <=)
+struct ComparisonFilter {
+	enum ComparisonType { NONE, GREATER, LESS, EQUAL, GREATER_EQUAL, LESS_EQUAL };
+	ComparisonType type;
+	float value;
+
+	ComparisonFilter() : type(NONE), value(0.0f) {}
+	
+	ComparisonFilter(const std::string& filterStr) {
+		ParseFilter(filterStr);
+	}
+
+	void ParseFilter(const std::string& filterStr) {
+		logger::trace("Parsing comparison filter: '{}'", filterStr);
+		if (filterStr == "NONE" || filterStr.empty()) {
+			type = NONE;
+			logger::debug("Comparison filter set to NONE");
+			return;
+		}
+
+		if (filterStr.find(">=") != std::string::npos) {
+			type = GREATER_EQUAL;
+			value = std::stof(filterStr.substr(2));
+			logger::debug("Parsed GREATER_EQUAL filter with value: {}", value);
+		} else if (filterStr.find("<=") != std::string::npos) {
+			type = LESS_EQUAL;
+			value = std::stof(filterStr.substr(2));
+			logger::debug("Parsed LESS_EQUAL filter with value: {}", value);
+		} else if (filterStr.find(">") != std::string::npos) {
+			type = GREATER;
+			value = std::stof(filterStr.substr(1));
+			logger::debug("Parsed GREATER filter with value: {}", value);
+		} else if (filterStr.find("<") != std::string::npos) {
+			type = LESS;
+			value = std::stof(filterStr.substr(1));
+			logger::debug("Parsed LESS filter with value: {}", value);
+		} else if (filterStr.find("=") != std::string::npos) {
+			type = EQUAL;
+			value = std::stof(filterStr.substr(1));
+			logger::debug("Parsed EQUAL filter with value: {}", value);
+		} else {
+			type = NONE;
+			logger::debug("Could not parse comparison filter, set to NONE");
+		}
+	}
+
+	bool Matches(float testValue) const {
+		bool result;
+		switch (type) {
+			case GREATER: 
+				result = testValue > value;
+				logger::trace("Comparison {} > {}: {}", testValue, value, result);
+				return result;
+			case LESS: 
+				result = testValue < value;
+				logger::trace("Comparison {} < {}: {}", testValue, value, result);
+				return result;
+			case EQUAL: 
+				result = testValue == value;
+				logger::trace("Comparison {} == {}: {}", testValue, value, result);
+				return result;
+			case GREATER_EQUAL: 
+				result = testValue >= value;
+				logger::trace("Comparison {} >= {}: {}", testValue, value, result);
+				return result;
+			case LESS_EQUAL: 
+				result = testValue <= value;
+				logger::trace("Comparison {} <= {}: {}", testValue, value, result);
+				return result;
+			case NONE: 
+				logger::trace("Comparison filter is NONE, returning true");
+				return true;
+			default: 
+				logger::trace("Unknown comparison type, returning true");
+				return true;
+		}
+	}
+
+	// Operator encoded as the accept mask used by ComparisonKernel
+	std::uint32_t AcceptMask() const {
+		switch (type) {
+			case GREATER: return ComparisonKernel::kGreater;
+			case LESS: return ComparisonKernel::kLess;
+			case EQUAL: return ComparisonKernel::kEqual;
+			case GREATER_EQUAL: return ComparisonKernel::kGreater | ComparisonKernel::kEqual;
+			case LESS_EQUAL: return ComparisonKernel::kLess | ComparisonKernel::kEqual;
+			default: return ComparisonKernel::kAny;
+		}
+	}
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "rulemask.h"
+
+#include <immintrin.h>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#	include <intrin.h>
+#	define CMSC_TARGET_AVX2
+#else
+#	include <cpuid.h>
+#	define CMSC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// Vectorized evaluation of many weight/value comparisons against one item.
+// Each row holds a weight threshold and a value threshold, each with its own
+// operator, encoded as "accept less / equal / greater" lane masks so that
+// every operator (including NONE) is the same branch-free expression.
+// NONE also accepts NaN, which no ordered comparison does, through a separate "always" mask.
+class ComparisonKernel {
+public:
+	enum Accept : std::uint32_t {
+		kLess = 1 << 0,
+		kEqual = 1 << 1,
+		kGreater = 1 << 2,
+		kAny = kLess | kEqual | kGreater
+	};
+
+	enum class ISA { Scalar, SSE, AVX2 };
+
+	void Clear() {
+		rows = 0;
+		hasValue = false;
+		weight = {};
+		value = {};
+	}
+
+	// Appends a row, returns its index
+	std::size_t AddRow(std::uint32_t weightAccept, float weightThreshold, std::uint32_t valueAccept, float valueThreshold) {
+		weight.Push(weightAccept, weightThreshold, rows);
+		value.Push(valueAccept, valueThreshold, rows);
+		hasValue |= valueAccept != kAny;
+		return rows++;
+	}
+
+	std::size_t Rows() const { return rows; }
+
+	// Whether any row actually filters on value, so callers can skip the expensive lookup
+	bool HasValueColumn() const { return hasValue; }
+
+	static ISA DetectISA() {
+		static const ISA isa = [] {
+			int regs[4]{};
+			Cpuid(regs, 1, 0);
+			bool osxsave = regs[2] & (1 << 27);
+			bool avx = regs[2] & (1 << 28);
+			if (osxsave && avx && (XGetBV() & 0x6) == 0x6) {
+				Cpuid(regs, 7, 0);
+				if (regs[1] & (1 << 5)) return ISA::AVX2;
+			}
+			return ISA::SSE;
+		}();
+		return isa;
+	}
+
+	// Writes one bit per row into out (resized to Rows())
+	void Evaluate(float itemWeight, float itemValue, RuleMask& out) const {
+		Evaluate(itemWeight, itemValue, out, DetectISA());
+	}
+
+	void Evaluate(float itemWeight, float itemValue, RuleMask& out, ISA isa) const {
+		out.Resize(rows);
+		if (!rows) return;
+		switch (isa) {
+		case ISA::AVX2:
+			EvaluateAVX2(itemWeight, itemValue, out);
+			break;
+		case ISA::SSE:
+			EvaluateSSE(itemWeight, itemValue, out);
+			break;
+		default:
+			EvaluateScalar(itemWeight, itemValue, out);
+			break;
+		}
+	}
+
+	// Weight column only, for static per-form evaluation where the value depends on extra data
+	void EvaluateWeight(float itemWeight, RuleMask& out) const {
+		out.Resize(rows);
+		for (std::size_t i = 0; i < rows; ++i) {
+			if (weight.Matches(i, itemWeight)) out.Set(i);
+		}
+	}
+
+private:
+	struct Column {
+		std::vector<float> threshold;
+		std::vector<std::uint32_t> less, equal, greater, always;
+
+		void Push(std::uint32_t accept, float t, std::size_t index) {
+			// pad to a multiple of 8 with rows that never match
+			std::size_t padded = (index + 8) & ~std::size_t(7);
+			threshold.resize(padded, 0.0f);
+			less.resize(padded, 0);
+			equal.resize(padded, 0);
+			greater.resize(padded, 0);
+			always.resize(padded, 0);
+			threshold[index] = t;
+			less[index] = (accept & kLess) ? ~0u : 0u;
+			equal[index] = (accept & kEqual) ? ~0u : 0u;
+			greater[index] = (accept & kGreater) ? ~0u : 0u;
+			always[index] = accept == kAny ? ~0u : 0u;
+		}
+
+		bool Matches(std::size_t i, float v) const {
+			float t = threshold[i];
+			return (v < t && less[i]) || (v == t && equal[i]) || (v > t && greater[i]) || always[i];
+		}
+	};
+
+	static void Cpuid(int regs[4], int leaf, int subleaf) {
+#ifdef _MSC_VER
+		__cpuidex(regs, leaf, subleaf);
+#else
+		__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	}
+
+	static std::uint64_t XGetBV() {
+#ifdef _MSC_VER
+		return _xgetbv(0);
+#else
+		std::uint32_t lo, hi;
+		__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		return (static_cast<std::uint64_t>(hi) << 32) | lo;
+#endif
+	}
+
+	void EvaluateScalar(float w, float v, RuleMask& out) const {
+		for (std::size_t i = 0; i < rows; ++i) {
+			if (weight.Matches(i, w) && value.Matches(i, v)) out.Set(i);
+		}
+	}
+
+	static __m128 ColumnSSE(const Column& c, std::size_t i, __m128 v) {
+		__m128 t = _mm_loadu_ps(&c.threshold[i]);
+		__m128 lt = _mm_and_ps(_mm_cmplt_ps(v, t), _mm_loadu_ps(reinterpret_cast<const float*>(&c.less[i])));
+		__m128 eq = _mm_and_ps(_mm_cmpeq_ps(v, t), _mm_loadu_ps(reinterpret_cast<const float*>(&c.equal[i])));
+		__m128 gt = _mm_and_ps(_mm_cmpgt_ps(v, t), _mm_loadu_ps(reinterpret_cast<const float*>(&c.greater[i])));
+		__m128 any = _mm_loadu_ps(reinterpret_cast<const float*>(&c.always[i]));
+		return _mm_or_ps(_mm_or_ps(lt, eq), _mm_or_ps(gt, any));
+	}
+
+	void EvaluateSSE(float w, float v, RuleMask& out) const {
+		__m128 wv = _mm_set1_ps(w);
+		__m128 vv = _mm_set1_ps(v);
+		for (std::size_t i = 0; i < rows; i += 4) {
+			__m128 hit = _mm_and_ps(ColumnSSE(weight, i, wv), ColumnSSE(value, i, vv));
+			std::uint64_t bits = static_cast<std::uint32_t>(_mm_movemask_ps(hit));
+			if (bits) out.SetBits(i, bits, std::min<std::size_t>(4, rows - i));
+		}
+	}
+
+	CMSC_TARGET_AVX2 static __m256 ColumnAVX2(const Column& c, std::size_t i, __m256 v) {
+		__m256 t = _mm256_loadu_ps(&c.threshold[i]);
+		__m256 lt = _mm256_and_ps(_mm256_cmp_ps(v, t, _CMP_LT_OQ), _mm256_loadu_ps(reinterpret_cast<const float*>(&c.less[i])));
+		__m256 eq = _mm256_and_ps(_mm256_cmp_ps(v, t, _CMP_EQ_OQ), _mm256_loadu_ps(reinterpret_cast<const float*>(&c.equal[i])));
+		__m256 gt = _mm256_and_ps(_mm256_cmp_ps(v, t, _CMP_GT_OQ), _mm256_loadu_ps(reinterpret_cast<const float*>(&c.greater[i])));
+		__m256 any = _mm256_loadu_ps(reinterpret_cast<const float*>(&c.always[i]));
+		return _mm256_or_ps(_mm256_or_ps(lt, eq), _mm256_or_ps(gt, any));
+	}
+
+	CMSC_TARGET_AVX2 void EvaluateAVX2(float w, float v, RuleMask& out) const {
+		__m256 wv = _mm256_set1_ps(w);
+		__m256 vv = _mm256_set1_ps(v);
+		for (std::size_t i = 0; i < rows; i += 8) {
+			__m256 hit = _mm256_and_ps(ColumnAVX2(weight, i, wv), ColumnAVX2(value, i, vv));
+			std::uint64_t bits = static_cast<std::uint32_t>(_mm256_movemask_ps(hit));
+			if (bits) out.SetBits(i, bits, std::min<std::size_t>(8, rows - i));
+		}
+	}
+
+	Column weight;
+	Column value;
+	std::size_t rows = 0;
+	bool hasValue = false;
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Post-processing of restocked counts: multiplier, rounding and caps in one pass.
+// Entries whose count is not positive are scaled and rounded like the rest (the multiplier has always
+// applied to removals too) but never capped, so a low cap cannot turn a removal into stock. Entries whose
+// scaled count is NaN (a NaN multiplier) pass through untouched: there is no count to round or cap.
+class CountStage {
+public:
+	enum class Rounding : std::int32_t { Truncate, Floor, Ceil, Nearest };
+
+	// Cap value meaning "no cap", matching the 0 default of ConfigEntry::low_cap/high_cap
+	static constexpr std::int32_t kNoCap = 0;
+
+	// Inventories at least this large go through the SSE path
+	static constexpr std::size_t kVectorThreshold = 16;
+
+	static Rounding ParseRounding(const std::string& str) {
+		if (str == "floor") return Rounding::Floor;
+		if (str == "ceil") return Rounding::Ceil;
+		if (str == "nearest") return Rounding::Nearest;
+		if (str != "truncate") logger::warn("Unknown count rounding mode '{}', truncating instead (truncate, floor, ceil or nearest)", str);
+		return Rounding::Truncate;
+	}
+
+	// Queues one entry, returns its lane index. Caps equal to kNoCap are ignored.
+	std::size_t Push(std::int32_t a_count, float a_multiplier, std::int32_t a_low, std::int32_t a_high, Rounding a_rounding) {
+		count.push_back(a_count);
+		multiplier.push_back(a_multiplier);
+		low.push_back(a_low == kNoCap ? INT32_MIN : a_low);
+		high.push_back(a_high == kNoCap ? INT32_MAX : a_high);
+		rounding.push_back(static_cast<std::int32_t>(a_rounding));
+		return count.size() - 1;
+	}
+
+	std::size_t Size() const { return count.size(); }
+
+	// Processes every lane in place; Result(i) reads the final count
+	void Run() {
+		std::size_t i = 0;
+		if (Size() >= kVectorThreshold) {
+			for (; i + 4 <= Size(); i += 4) RunSSE(i);
+		}
+		for (; i < Size(); ++i) count[i] = Scalar(count[i], multiplier[i], low[i], high[i], static_cast<Rounding>(rounding[i]));
+	}
+
+	std::int32_t Result(std::size_t i) const { return count[i]; }
+
+	// Reference implementation, the SSE path must produce identical results
+	static std::int32_t Scalar(std::int32_t a_count, float a_multiplier, std::int32_t a_low, std::int32_t a_high, Rounding a_rounding) {
+		const float product = static_cast<float>(a_count) * a_multiplier;
+		if (std::isnan(product)) return a_count;
+
+		float x = std::clamp(product, kMinFloat, kMaxFloat);
+		std::int32_t t = static_cast<std::int32_t>(x);
+		float tf = static_cast<float>(t);
+		std::int32_t r = t;
+		switch (a_rounding) {
+		case Rounding::Floor:
+			r = t - (tf > x ? 1 : 0);
+			break;
+		case Rounding::Ceil:
+			r = t + (tf < x ? 1 : 0);
+			break;
+		case Rounding::Nearest:
+			r = static_cast<std::int32_t>(std::lround(x));
+			break;
+		default:
+			break;
+		}
+		if (a_count <= 0) return r;
+		r = std::max(r, a_low);
+		return std::min(r, a_high);
+	}
+
+private:
+	// Largest floats that convert to int32 without overflow
+	static constexpr float kMinFloat = -2147483520.0f;
+	static constexpr float kMaxFloat = 2147483520.0f;
+
+	static __m128i Select(__m128i mask, __m128i a, __m128i b) {
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	void RunSSE(std::size_t i) {
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&count[i]));
+		__m128 m = _mm_loadu_ps(&multiplier[i]);
+		__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&low[i]));
+		__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&high[i]));
+		__m128i mode = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&rounding[i]));
+
+		const __m128 minF = _mm_set1_ps(kMinFloat);
+		const __m128 maxF = _mm_set1_ps(kMaxFloat);
+
+		__m128 product = _mm_mul_ps(_mm_cvtepi32_ps(c), m);
+		__m128 x = _mm_min_ps(_mm_max_ps(product, minF), maxF);
+		__m128i t = _mm_cvttps_epi32(x);
+		__m128 tf = _mm_cvtepi32_ps(t);
+
+		// compare masks are -1 where true, so adding subtracts one and subtracting adds one
+		__m128i floorV = _mm_add_epi32(t, _mm_castps_si128(_mm_cmpgt_ps(tf, x)));
+		__m128i ceilV = _mm_sub_epi32(t, _mm_castps_si128(_mm_cmplt_ps(tf, x)));
+		// halves away from zero like std::lround; x - trunc(x) is exact, unlike adding 0.5 to x
+		__m128 fraction = _mm_sub_ps(x, tf);
+		__m128i nearestV = _mm_sub_epi32(t, _mm_castps_si128(_mm_cmpge_ps(fraction, _mm_set1_ps(0.5f))));
+		nearestV = _mm_add_epi32(nearestV, _mm_castps_si128(_mm_cmple_ps(fraction, _mm_set1_ps(-0.5f))));
+
+		__m128i r = t;
+		r = Select(_mm_cmpeq_epi32(mode, _mm_set1_epi32(static_cast<std::int32_t>(Rounding::Floor))), floorV, r);
+		r = Select(_mm_cmpeq_epi32(mode, _mm_set1_epi32(static_cast<std::int32_t>(Rounding::Ceil))), ceilV, r);
+		r = Select(_mm_cmpeq_epi32(mode, _mm_set1_epi32(static_cast<std::int32_t>(Rounding::Nearest))), nearestV, r);
+
+		// caps only for positive counts, and NaN products leave the count as it was
+		__m128i capped = Select(_mm_cmplt_epi32(r, lo), lo, r);
+		capped = Select(_mm_cmpgt_epi32(capped, hi), hi, capped);
+		r = Select(_mm_cmpgt_epi32(c, _mm_setzero_si128()), capped, r);
+		r = Select(_mm_castps_si128(_mm_cmpord_ps(product, product)), r, c);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&count[i]), r);
+	}
+
+	std::vector<std::int32_t> count;
+	std::vector<float> multiplier;
+	std::vector<std::int32_t> low;
+	std::vector<std::int32_t> high;
+	std::vector<std::int32_t> rounding;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+// FNV-1a over the value-relevant extra data of an inventory stack, in the order the lists are walked.
+// Game-independent so the key can be tested without the game; ValueCache feeds it from the extra lists.
+// Every field InventoryEntryData::GetValue() reads has a method here: a field left out would make
+// stacks that price differently share a key.
+class ExtraHash {
+public:
+	// Tags keep a value of one field from colliding with the same value of another
+	enum Tag : std::uint64_t { kList = 0xE7, kEnchantment = 1, kHealth = 2, kCharge = 3, kSoul = 4 };
+
+	// Start of the next extra data list of the stack
+	void List() { Mix(kList); }
+
+	void Enchantment(std::uint32_t formID, std::uint16_t charge) {
+		Mix(kEnchantment << 32 | formID);
+		Mix(charge);
+	}
+
+	// Temper level
+	void Health(float health) { Mix(kHealth << 32 | std::bit_cast<std::uint32_t>(health)); }
+
+	void Charge(float charge) { Mix(kCharge << 32 | std::bit_cast<std::uint32_t>(charge)); }
+
+	// Soul level held by a soul gem
+	void Soul(std::uint8_t level) { Mix(kSoul << 32 | level); }
+
+	std::uint64_t Value() const { return hash; }
+
+private:
+	void Mix(std::uint64_t value) { hash = (hash ^ value) * 0x100000001B3ull; }
+
+	std::uint64_t hash = 0xCBF29CE484222325ull;
+};
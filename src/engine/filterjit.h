@@ -0,0 +1,283 @@
+#pragma once
+
+#include "filtervm.h"
+
+#include <xbyak.h>
+#include <bit>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+// Native code for a compiled section. Evaluates every entry against one context in a single call
+// and sets the bit of each matching entry; thresholds and FormIDs are inlined as immediates.
+// Only row mode is supported: the caller must pass the item filter rows from EvaluateItemRows.
+class FilterJIT : public Xbyak::CodeGenerator {
+public:
+	using Fn = void (*)(const FilterVM::Context* ctx, const std::uint64_t* rows, std::uint64_t* matched);
+
+	// Returns nullptr when the program uses something the JIT cannot lower, callers keep interpreting
+	static std::unique_ptr<FilterJIT> Compile(const FilterVM::Program& program, const std::vector<std::uint32_t>& entryStart) {
+		try {
+			return std::unique_ptr<FilterJIT>(new FilterJIT(program, entryStart));
+		} catch (const std::exception& e) {
+			logger::warn("Rule JIT failed, using the bytecode interpreter: {}", e.what());
+			return nullptr;
+		}
+	}
+
+	void Run(const FilterVM::Context& ctx, const RuleMask& rows, RuleMask& matched) const {
+		fn(&ctx, rows.Data(), matched.Data());
+	}
+
+private:
+	FilterJIT(const FilterVM::Program& program, const std::vector<std::uint32_t>& entryStart) :
+		Xbyak::CodeGenerator(4096 + program.code.size() * 48 + entryStart.size() * 32) {
+
+		// rbx = ctx, rsi = rows, rdi = matched, xmm6 = accumulator; Windows x64 ABI
+		push(rbx);
+		push(rsi);
+		push(rdi);
+		sub(rsp, 0x30);
+		movdqu(ptr[rsp + 0x20], xmm6);
+		mov(rbx, rcx);
+		mov(rsi, rdx);
+		mov(rdi, r8);
+
+		for (std::size_t i = 0; i < entryStart.size(); ++i) EmitEntry(program, entryStart[i], i);
+
+		movdqu(xmm6, ptr[rsp + 0x20]);
+		add(rsp, 0x30);
+		pop(rdi);
+		pop(rsi);
+		pop(rbx);
+		ret();
+
+		fn = getCode<Fn>();
+	}
+
+	void EmitEntry(const FilterVM::Program& program, std::uint32_t pc, std::size_t entry) {
+		using FilterVM::Op;
+		Xbyak::Label reject, done;
+
+		// Failures inside a shared predicate go to a stub that records kFailed before rejecting
+		struct MemoLabels {
+			std::uint32_t id;
+			Xbyak::Label fail;
+			Xbyak::Label end;
+		};
+		std::vector<std::unique_ptr<MemoLabels>> memos;
+		Xbyak::Label* failTarget = &reject;
+
+		for (;;) {
+			const auto& in = program.code[pc];
+			if (in.fail != FilterVM::kReject) throw std::runtime_error("non-reject jump target");
+			Xbyak::Label& next = *failTarget;
+
+			switch (in.op) {
+			case Op::Row:
+				mov(rax, qword[rsi + (in.operand >> 6) * 8]);
+				bt(rax, in.operand & 63);
+				jnc(next, T_NEAR);
+				pc += 1 + in.skip;
+				continue;
+			case Op::RequireItem:
+				mov(rax, qword[rbx + offsetof(FilterVM::Context, item)]);
+				test(rax, rax);
+				jz(next, T_NEAR);
+				cmp(qword[rax + offsetof(RE::InventoryEntryData, object)], 0);
+				je(next, T_NEAR);
+				break;
+			case Op::RequireTrader:
+				cmp(qword[rbx + offsetof(FilterVM::Context, trader)], 0);
+				je(next, T_NEAR);
+				break;
+			case Op::RequirePlayer:
+				cmp(qword[rbx + offsetof(FilterVM::Context, player)], 0);
+				je(next, T_NEAR);
+				break;
+			case Op::TestItemForm:
+				mov(rax, qword[rbx + offsetof(FilterVM::Context, item)]);
+				mov(rax, qword[rax + offsetof(RE::InventoryEntryData, object)]);
+				cmp(dword[rax + offsetof(RE::TESForm, formID)], in.operand);
+				jne(next, T_NEAR);
+				break;
+			case Op::TestKeyword:
+				CallTest(&TestKeyword, in.operand, next);
+				break;
+			case Op::TestMerchantForm:
+				CallTest(&TestMerchantForm, in.operand, next);
+				break;
+			case Op::TestPerk:
+				CallTest(&TestPerk, reinterpret_cast<std::uintptr_t>(program.pool[in.operand]), next);
+				break;
+			case Op::LoadGlobal:
+				CallLoad(&LoadGlobal, reinterpret_cast<std::uintptr_t>(program.pool[in.operand]->As<RE::TESGlobal>()));
+				break;
+			case Op::LoadWeight:
+				CallLoad(&LoadWeight, 0);
+				break;
+			case Op::LoadValue:
+				CallLoad(&LoadValue, 0);
+				break;
+			case Op::LoadRelationship:
+				CallLoad(&LoadRelationship, 0);
+				break;
+			case Op::LoadLevel:
+				CallLoad(&LoadLevel, 0);
+				break;
+			case Op::LoadSkill:
+				CallLoad(&LoadSkill, in.operand);
+				break;
+			case Op::Memo: {
+				auto& memo = *memos.emplace_back(std::make_unique<MemoLabels>());
+				memo.id = in.operand;
+				Xbyak::Label evaluate;
+				mov(rax, qword[rbx + offsetof(FilterVM::Context, memo)]);
+				test(rax, rax);
+				jz(evaluate, T_NEAR);
+				movzx(eax, byte[rax + in.operand]);
+				cmp(eax, FilterVM::kPassed);
+				je(memo.end, T_NEAR);
+				cmp(eax, FilterVM::kFailed);
+				je(reject, T_NEAR);
+				L(evaluate);
+				failTarget = &memo.fail;
+				break;
+			}
+			case Op::MemoPass: {
+				Xbyak::Label noMemo;
+				mov(rax, qword[rbx + offsetof(FilterVM::Context, memo)]);
+				test(rax, rax);
+				jz(noMemo, T_NEAR);
+				mov(byte[rax + in.operand], FilterVM::kPassed);
+				L(noMemo);
+				L(memos.back()->end);
+				failTarget = &reject;
+				break;
+			}
+			case Op::Compare:
+				EmitCompare(in.accept, in.imm, next);
+				break;
+			case Op::Fail:
+				jmp(next, T_NEAR);
+				break;
+			case Op::Accept:
+				mov(rax, 1ull << (entry & 63));
+				or_(qword[rdi + (entry >> 6) * 8], rax);
+				jmp(done, T_NEAR);
+
+				for (auto& memo : memos) {
+					L(memo->fail);
+					mov(rax, qword[rbx + offsetof(FilterVM::Context, memo)]);
+					test(rax, rax);
+					jz(reject, T_NEAR);
+					mov(byte[rax + memo->id], FilterVM::kFailed);
+					jmp(reject, T_NEAR);
+				}
+				L(reject);
+				L(done);
+				return;
+			}
+			++pc;
+		}
+	}
+
+	// Branches to `fail` unless the accumulator passes; unordered (NaN) always fails, like FilterVM::Compare
+	void EmitCompare(std::uint8_t accept, float imm, const Xbyak::Label& fail) {
+		constexpr auto kL = ComparisonKernel::kLess, kE = ComparisonKernel::kEqual, kG = ComparisonKernel::kGreater;
+
+		if (accept == ComparisonKernel::kAny) return;
+		if (!accept) {
+			jmp(fail, T_NEAR);
+			return;
+		}
+
+		mov(eax, std::bit_cast<std::uint32_t>(imm));
+		movd(xmm1, eax);
+		switch (accept) {
+		case kG:
+			comiss(xmm6, xmm1);
+			jbe(fail, T_NEAR);
+			break;
+		case kG | kE:
+			comiss(xmm6, xmm1);
+			jb(fail, T_NEAR);
+			break;
+		case kL:
+			comiss(xmm1, xmm6);
+			jbe(fail, T_NEAR);
+			break;
+		case kL | kE:
+			comiss(xmm1, xmm6);
+			jb(fail, T_NEAR);
+			break;
+		case kE:
+			comiss(xmm6, xmm1);
+			jne(fail, T_NEAR);
+			jp(fail, T_NEAR);
+			break;
+		default:  // kL | kG
+			comiss(xmm6, xmm1);
+			je(fail, T_NEAR);
+			break;
+		}
+	}
+
+	template <class R>
+	void Call(R (*helper)(const FilterVM::Context*, std::uintptr_t), std::uintptr_t arg) {
+		mov(rcx, rbx);
+		mov(rdx, arg);
+		mov(rax, reinterpret_cast<std::uintptr_t>(helper));
+		call(rax);
+	}
+
+	void CallTest(bool (*helper)(const FilterVM::Context*, std::uintptr_t), std::uintptr_t arg, const Xbyak::Label& fail) {
+		Call(helper, arg);
+		test(al, al);
+		jz(fail, T_NEAR);
+	}
+
+	void CallLoad(float (*helper)(const FilterVM::Context*, std::uintptr_t), std::uintptr_t arg) {
+		Call(helper, arg);
+		movss(xmm6, xmm0);
+	}
+
+	// Out-of-line pieces that need engine calls. Loads return NaN on failure so the following compare fails.
+	static bool TestKeyword(const FilterVM::Context* ctx, std::uintptr_t index) {
+		return KeywordIndex::getInstance()->Test(ctx->item->object, static_cast<std::uint32_t>(index));
+	}
+
+	static bool TestMerchantForm(const FilterVM::Context* ctx, std::uintptr_t formID) {
+		return FilterVM::TestMerchantForm(*ctx, static_cast<RE::FormID>(formID));
+	}
+
+	static bool TestPerk(const FilterVM::Context* ctx, std::uintptr_t perk) {
+		return FilterVM::TestPerk(*ctx, reinterpret_cast<RE::BGSPerk*>(perk));
+	}
+
+	static float LoadWeight(const FilterVM::Context* ctx, std::uintptr_t) {
+		return ctx->item->object->GetWeight();
+	}
+
+	static float LoadValue(const FilterVM::Context* ctx, std::uintptr_t) {
+		return FilterVM::LoadValue(*ctx);
+	}
+
+	static float LoadRelationship(const FilterVM::Context* ctx, std::uintptr_t) {
+		return FilterVM::LoadRelationship(*ctx);
+	}
+
+	static float LoadLevel(const FilterVM::Context* ctx, std::uintptr_t) {
+		return FilterVM::LoadLevel(*ctx);
+	}
+
+	static float LoadGlobal(const FilterVM::Context* ctx, std::uintptr_t global) {
+		return FilterVM::LoadGlobal(*ctx, reinterpret_cast<RE::TESGlobal*>(global));
+	}
+
+	static float LoadSkill(const FilterVM::Context* ctx, std::uintptr_t id) {
+		return FilterVM::LoadSkill(*ctx, static_cast<std::uint32_t>(id));
+	}
+
+	Fn fn = nullptr;
+};
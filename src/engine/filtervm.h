@@ -0,0 +1,383 @@
+#pragma once
+
+#include "comparisonkernel.h"
+#include "keywordindex.h"
+#include "predicatestats.h"
+#include "relationshipcache.h"
+#include "valuecache.h"
+#include "rulemask.h"
+
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#ifdef _MSC_VER
+#	include <intrin.h>
+#else
+#	include <x86intrin.h>
+#endif
+
+// Compact bytecode for filter sets. Every entry compiles to a straight run of loads, compares and
+// tests; a failing instruction jumps to its `fail` target, reaching Accept means the entry matches.
+namespace FilterVM {
+	enum class Op : std::uint8_t {
+		RequireItem,      // item section present: item and base object must exist
+		RequireTrader,
+		RequirePlayer,
+		Row,              // precomputed item filter row `operand`; skips `skip` instructions when available
+		TestItemForm,     // item base FormID == operand
+		TestKeyword,      // item has the keyword of KeywordIndex bit `operand`
+		LoadWeight,
+		LoadValue,
+		TestMerchantForm, // trader or its base FormID == operand
+		LoadRelationship,
+		LoadGlobal,       // pool[operand] as TESGlobal
+		LoadLevel,
+		LoadSkill,        // actor value `operand`
+		TestPerk,         // player has perk pool[operand]
+		Memo,             // shared predicate `operand`: reuse a known result, skipping `skip` instructions on pass
+		MemoPass,         // end of shared predicate `operand`, record the pass
+		Compare,          // accumulator against imm with ComparisonKernel accept bits
+		Fail,             // unresolved editor ID, never matches
+		Accept
+	};
+
+	// Fail target that ends evaluation with no match
+	constexpr std::uint32_t kReject = UINT32_MAX;
+
+	struct Instr {
+		Op op;
+		std::uint8_t accept = 0;
+		std::uint16_t skip = 0;
+		std::uint32_t operand = 0;
+		float imm = 0.0f;
+		std::uint32_t fail = kReject;
+	};
+	static_assert(sizeof(Instr) == 16);
+
+	struct Program {
+		std::vector<Instr> code;
+		std::vector<std::uint32_t> group; // PredicateStats id of the predicate each instruction belongs to
+		std::vector<RE::TESForm*> pool;
+
+		std::uint32_t Emit(Instr in, std::uint32_t stat = PredicateStats::kNone) {
+			code.push_back(in);
+			group.push_back(stat);
+			return static_cast<std::uint32_t>(code.size() - 1);
+		}
+
+		std::uint32_t Pool(RE::TESForm* form) {
+			pool.push_back(form);
+			return static_cast<std::uint32_t>(pool.size() - 1);
+		}
+
+		void Clear() {
+			code.clear();
+			group.clear();
+			pool.clear();
+		}
+	};
+
+	// Results of shared merchant/player predicates, indexed by predicate ID
+	enum MemoState : std::uint8_t { kUnknown, kPassed, kFailed };
+
+	inline int GetRelationshipRank(RE::Actor* trader) {
+		return RelationshipCache::getInstance()->Get(trader);
+	}
+
+	// Merchant/player game state of one call or batch, read from the engine the first time a rule needs it.
+	// The trader and player must stay the same until the next Reset.
+	class Snapshot {
+	public:
+		void Reset() {
+			if (pinned) return;
+			valid = 0;
+			skillValid.reset();
+			perks.clear();
+			globals.clear();
+		}
+
+		// Replay: the seeded values stand in for the game's and survive Reset() until unpinned
+		void Pin(bool pin) {
+			pinned = false;
+			Reset();
+			pinned = pin;
+		}
+
+		void SeedTraderBase(RE::FormID id) { Seed(kTraderBase, traderBase, id); }
+		void SeedRelationship(float value) { Seed(kRelationship, relationship, value); }
+		void SeedLevel(float value) { Seed(kLevel, level, value); }
+
+		void SeedSkill(std::uint32_t id, float value) {
+			if (id >= skills.size()) return;
+			skills[id] = value;
+			skillValid.set(id);
+		}
+
+		void SeedPerk(RE::BGSPerk* perk, bool has) { perks.emplace_back(perk, has); }
+		void SeedGlobal(RE::TESGlobal* global, float value) { globals.emplace_back(global, value); }
+
+		RE::FormID TraderBase(RE::Actor* trader) {
+			if (Miss(kTraderBase)) traderBase = trader->GetBaseObject()->formID;
+			return traderBase;
+		}
+
+		float Relationship(RE::Actor* trader) {
+			if (Miss(kRelationship)) relationship = static_cast<float>(GetRelationshipRank(trader));
+			return relationship;
+		}
+
+		float Level(RE::PlayerCharacter* player) {
+			if (Miss(kLevel)) level = static_cast<float>(player->GetLevel());
+			return level;
+		}
+
+		// NaN when the player has no actor value owner
+		float Skill(RE::PlayerCharacter* player, std::uint32_t id) {
+			++reads;
+			if (id >= skills.size()) return ReadSkill(player, id);
+			if (!skillValid.test(id)) {
+				skills[id] = ReadSkill(player, id);
+				skillValid.set(id);
+			}
+			return skills[id];
+		}
+
+		bool HasPerk(RE::PlayerCharacter* player, RE::BGSPerk* perk) {
+			++reads;
+			for (auto&& [known, has] : perks) {
+				if (known == perk) return has;
+			}
+			++calls;
+			return perks.emplace_back(perk, player->HasPerk(perk)).second;
+		}
+
+		// Only seeded globals are held: a live one is a plain field read, cheaper than a lookup here
+		float Global(RE::TESGlobal* global) const {
+			for (auto&& [known, value] : globals) {
+				if (known == global) return value;
+			}
+			return global->value;
+		}
+
+		// Game state reads served, and how many of them called into the engine
+		std::uint64_t Reads() const { return reads; }
+		std::uint64_t Calls() const { return calls; }
+
+		void ResetCounters() {
+			reads = 0;
+			calls = 0;
+		}
+
+	private:
+		enum Field : std::uint32_t { kTraderBase = 1, kRelationship = 2, kLevel = 4 };
+
+		template <class T>
+		void Seed(Field field, T& into, T value) {
+			into = value;
+			valid |= field;
+		}
+
+		bool Miss(Field field) {
+			++reads;
+			if (valid & field) return false;
+			valid |= field;
+			++calls;
+			return true;
+		}
+
+		float ReadSkill(RE::PlayerCharacter* player, std::uint32_t id) {
+			++calls;
+			auto av = player->AsActorValueOwner();
+			return av ? av->GetActorValue(static_cast<RE::ActorValue>(id)) : std::numeric_limits<float>::quiet_NaN();
+		}
+
+		static constexpr std::size_t kSkills = static_cast<std::size_t>(RE::ActorValue::kTotal);
+
+		std::uint32_t valid = 0;
+		RE::FormID traderBase = 0;
+		float relationship = 0.0f;
+		float level = 0.0f;
+		std::array<float, kSkills> skills{};
+		std::bitset<kSkills> skillValid;
+		std::vector<std::pair<RE::BGSPerk*, bool>> perks;
+		std::vector<std::pair<RE::TESGlobal*, float>> globals;
+		bool pinned = false;
+		std::uint64_t reads = 0;
+		std::uint64_t calls = 0;
+	};
+
+	// Inputs of one evaluation
+	struct Context {
+		RE::InventoryEntryData* item = nullptr;
+		RE::Actor* trader = nullptr;
+		RE::PlayerCharacter* player = nullptr;
+		const RuleMask* rows = nullptr; // item filter rows from EvaluateItemRows, if already computed
+		std::uint8_t* memo = nullptr;   // MemoState per predicate for the current session, if any
+		Snapshot* state = nullptr;      // game state of the current call or batch, if any
+	};
+
+	inline float LoadValue(const Context& ctx) {
+		return static_cast<float>(ValueCache::getInstance()->Get(ctx.item));
+	}
+
+	// Game state loads shared by the interpreter and the JIT, served from the snapshot when there is one
+	inline bool TestMerchantForm(const Context& ctx, RE::FormID formID) {
+		if (ctx.trader->formID == formID) return true;
+		return (ctx.state ? ctx.state->TraderBase(ctx.trader) : ctx.trader->GetBaseObject()->formID) == formID;
+	}
+
+	inline float LoadRelationship(const Context& ctx) {
+		return ctx.state ? ctx.state->Relationship(ctx.trader) : static_cast<float>(GetRelationshipRank(ctx.trader));
+	}
+
+	inline float LoadLevel(const Context& ctx) {
+		return ctx.state ? ctx.state->Level(ctx.player) : static_cast<float>(ctx.player->GetLevel());
+	}
+
+	inline float LoadSkill(const Context& ctx, std::uint32_t id) {
+		if (ctx.state) return ctx.state->Skill(ctx.player, id);
+		auto av = ctx.player->AsActorValueOwner();
+		return av ? av->GetActorValue(static_cast<RE::ActorValue>(id)) : std::numeric_limits<float>::quiet_NaN();
+	}
+
+	inline float LoadGlobal(const Context& ctx, RE::TESGlobal* global) {
+		return ctx.state ? ctx.state->Global(global) : global->value;
+	}
+
+	inline bool TestPerk(const Context& ctx, RE::BGSPerk* perk) {
+		return ctx.state ? ctx.state->HasPerk(ctx.player, perk) : ctx.player->HasPerk(perk);
+	}
+
+	inline bool Compare(float acc, std::uint8_t accept, float imm) {
+		return (acc < imm && (accept & ComparisonKernel::kLess)) ||
+		       (acc == imm && (accept & ComparisonKernel::kEqual)) ||
+		       (acc > imm && (accept & ComparisonKernel::kGreater));
+	}
+
+	// Runs the program from `pc` until Accept (match) or a failed instruction jumping to kReject.
+	// The profiling flavour times every predicate group and records whether it rejected.
+	template <bool Profile>
+	inline bool Execute(const Program& program, std::uint32_t pc, const Context& ctx, PredicateStats* stats) {
+		const Instr* code = program.code.data();
+		float acc = 0.0f;
+
+		std::uint32_t memo = PredicateStats::kNone;  // shared predicate being evaluated
+		std::uint32_t current = PredicateStats::kNone;
+		std::uint64_t start = 0;
+		auto close = [&](bool rejected) {
+			if (current != PredicateStats::kNone) stats->Record(current, __rdtsc() - start, rejected);
+			current = PredicateStats::kNone;
+		};
+
+		for (;;) {
+			const Instr& in = code[pc];
+			if constexpr (Profile) {
+				if (program.group[pc] != current) {
+					close(false);
+					current = program.group[pc];
+					start = __rdtsc();
+				}
+			}
+			bool ok = true;
+			switch (in.op) {
+			case Op::RequireItem:
+				ok = ctx.item && ctx.item->object;
+				break;
+			case Op::RequireTrader:
+				ok = ctx.trader != nullptr;
+				break;
+			case Op::RequirePlayer:
+				ok = ctx.player != nullptr;
+				break;
+			case Op::Row:
+				if (ctx.rows) {
+					if (!ctx.rows->Test(in.operand)) {
+						if constexpr (Profile) close(true);
+						return false;
+					}
+					pc += 1 + in.skip;
+					continue;
+				}
+				break;
+			case Op::TestItemForm:
+				ok = ctx.item->object->GetFormID() == in.operand;
+				break;
+			case Op::TestKeyword:
+				ok = KeywordIndex::getInstance()->Test(ctx.item->object, in.operand);
+				break;
+			case Op::LoadWeight:
+				acc = ctx.item->object->GetWeight();
+				break;
+			case Op::LoadValue:
+				acc = LoadValue(ctx);
+				break;
+			case Op::TestMerchantForm:
+				ok = TestMerchantForm(ctx, in.operand);
+				break;
+			case Op::LoadRelationship:
+				acc = LoadRelationship(ctx);
+				break;
+			case Op::LoadGlobal:
+				acc = LoadGlobal(ctx, program.pool[in.operand]->As<RE::TESGlobal>());
+				break;
+			case Op::LoadLevel:
+				acc = LoadLevel(ctx);
+				break;
+			case Op::LoadSkill:
+				acc = LoadSkill(ctx, in.operand);
+				ok = !std::isnan(acc);
+				break;
+			case Op::TestPerk:
+				ok = TestPerk(ctx, program.pool[in.operand]->As<RE::BGSPerk>());
+				break;
+			case Op::Memo:
+				if (ctx.memo) {
+					if (ctx.memo[in.operand] == kPassed) {
+						pc += 1 + in.skip;
+						continue;
+					}
+					ok = ctx.memo[in.operand] != kFailed;
+					memo = in.operand;
+				}
+				break;
+			case Op::MemoPass:
+				if (ctx.memo) ctx.memo[in.operand] = kPassed;
+				memo = PredicateStats::kNone;
+				break;
+			case Op::Compare:
+				ok = Compare(acc, in.accept, in.imm);
+				break;
+			case Op::Fail:
+				ok = false;
+				break;
+			case Op::Accept:
+				if constexpr (Profile) close(false);
+				return true;
+			}
+
+			if (ok) {
+				++pc;
+			} else {
+				if (memo != PredicateStats::kNone) {
+					ctx.memo[memo] = kFailed;
+					memo = PredicateStats::kNone;
+				}
+				if constexpr (Profile) close(true);
+				if (in.fail >= program.code.size()) return false;
+				pc = in.fail;
+			}
+		}
+	}
+
+	inline bool Run(const Program& program, std::uint32_t pc, const Context& ctx) {
+		return Execute<false>(program, pc, ctx, nullptr);
+	}
+
+	inline bool RunProfiled(const Program& program, std::uint32_t pc, const Context& ctx, PredicateStats& stats) {
+		return Execute<true>(program, pc, ctx, &stats);
+	}
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Snapshot of the form database for tools outside the game: every tradeable bound object and every
+// vendor NPC. Game-independent like capture.h. The file is laid out to be mapped and used in place:
+// fixed-size little-endian records and offsets from the start of the file, each table 8-byte aligned.
+//
+//   Header  magic, version, counts and the offset of every table
+//   Form    sorted by FormID, so a lookup is a binary search over the mapped table
+//   Vendor  sorted by FormID
+//   ids     u32 pool holding the keyword, faction and container lists of the records
+//   strings NUL-terminated editor IDs
+namespace FormDump {
+	inline constexpr char kMagic[8] = { 'S', 'C', 'F', 'O', 'R', 'M', 'S', '\0' };
+	inline constexpr std::uint32_t kVersion = 1;
+	inline constexpr std::uint32_t kNoString = UINT32_MAX;
+
+	struct Header {
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t headerSize;
+		std::uint32_t formCount;
+		std::uint32_t vendorCount;
+		std::uint32_t idCount;
+		std::uint32_t stringBytes;
+		std::uint64_t formsOffset;
+		std::uint64_t vendorsOffset;
+		std::uint64_t idsOffset;
+		std::uint64_t stringsOffset;
+	};
+	static_assert(sizeof(Header) == 64);
+
+	// A list in the id pool
+	struct Range {
+		std::uint32_t begin;
+		std::uint32_t count;
+	};
+
+	struct Form {
+		std::uint32_t formID;
+		std::uint32_t editorID;  // offset into the string table, kNoString without one
+		Range keywords;
+		float weight;
+		std::int32_t value;      // base value, before enchantments and tempering
+		std::uint8_t type;       // the game's form type code (WEAP, ARMO, ...)
+		std::uint8_t reserved[3]{};
+	};
+	static_assert(sizeof(Form) == 28);
+
+	struct Vendor {
+		std::uint32_t formID;     // actor base (NPC_)
+		std::uint32_t editorID;
+		Range factions;           // every faction of the NPC
+		Range containers;         // merchant chest references of its vendor factions
+	};
+	static_assert(sizeof(Vendor) == 24);
+
+	// Collects records and writes the file
+	class Builder {
+	public:
+		std::uint32_t String(std::string_view text) {
+			if (text.empty()) return kNoString;
+			const auto offset = static_cast<std::uint32_t>(strings.size());
+			strings.insert(strings.end(), text.begin(), text.end());
+			strings.push_back('\0');
+			return offset;
+		}
+
+		Range Ids(std::span<const std::uint32_t> list) {
+			const Range range{ static_cast<std::uint32_t>(ids.size()), static_cast<std::uint32_t>(list.size()) };
+			ids.insert(ids.end(), list.begin(), list.end());
+			return range;
+		}
+
+		void Add(const Form& form) { forms.push_back(form); }
+		void Add(const Vendor& vendor) { vendors.push_back(vendor); }
+
+		size_t Forms() const { return forms.size(); }
+		size_t Vendors() const { return vendors.size(); }
+
+		bool Write(const std::filesystem::path& path) {
+			std::ranges::sort(forms, {}, &Form::formID);
+			std::ranges::sort(vendors, {}, &Vendor::formID);
+
+			Header header{};
+			std::memcpy(header.magic, kMagic, sizeof(kMagic));
+			header.version = kVersion;
+			header.headerSize = sizeof(Header);
+			header.formCount = static_cast<std::uint32_t>(forms.size());
+			header.vendorCount = static_cast<std::uint32_t>(vendors.size());
+			header.idCount = static_cast<std::uint32_t>(ids.size());
+			header.stringBytes = static_cast<std::uint32_t>(strings.size());
+			std::uint64_t at = Align(sizeof(Header));
+			header.formsOffset = at;
+			at = Align(at + forms.size() * sizeof(Form));
+			header.vendorsOffset = at;
+			at = Align(at + vendors.size() * sizeof(Vendor));
+			header.idsOffset = at;
+			at = Align(at + ids.size() * sizeof(std::uint32_t));
+			header.stringsOffset = at;
+
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			if (!file.is_open()) return false;
+			Put(file, &header, sizeof(header), header.formsOffset);
+			Put(file, forms.data(), forms.size() * sizeof(Form), header.vendorsOffset);
+			Put(file, vendors.data(), vendors.size() * sizeof(Vendor), header.idsOffset);
+			Put(file, ids.data(), ids.size() * sizeof(std::uint32_t), header.stringsOffset);
+			file.write(strings.data(), strings.size());
+			return static_cast<bool>(file);
+		}
+
+	private:
+		static std::uint64_t Align(std::uint64_t offset) { return (offset + 7) & ~std::uint64_t{ 7 }; }
+
+		// Writes `bytes` and pads the file up to `next`
+		static void Put(std::ofstream& file, const void* data, size_t bytes, std::uint64_t next) {
+			file.write(static_cast<const char*>(data), bytes);
+			static constexpr char zeros[8] = {};
+			const auto written = static_cast<std::uint64_t>(file.tellp());
+			if (next > written) file.write(zeros, next - written);
+		}
+
+		std::vector<Form> forms;
+		std::vector<Vendor> vendors;
+		std::vector<std::uint32_t> ids;
+		std::vector<char> strings;
+	};
+
+	// Read-only view over a dump already in memory (mapped or read whole); nothing is copied
+	class View {
+	public:
+		// Empty view when the bytes are not a dump of this version or a table lies outside them
+		View(const void* data, size_t size) {
+			if (size < sizeof(Header)) return;
+			const auto* base = static_cast<const char*>(data);
+			const auto* head = reinterpret_cast<const Header*>(base);
+			if (std::memcmp(head->magic, kMagic, sizeof(kMagic)) != 0 || head->version != kVersion) return;
+			if (!Fits(size, head->formsOffset, head->formCount * sizeof(Form)) || !Fits(size, head->vendorsOffset, head->vendorCount * sizeof(Vendor)) ||
+				!Fits(size, head->idsOffset, head->idCount * sizeof(std::uint32_t)) || !Fits(size, head->stringsOffset, head->stringBytes)) {
+				return;
+			}
+			header = head;
+			forms = { reinterpret_cast<const Form*>(base + head->formsOffset), head->formCount };
+			vendors = { reinterpret_cast<const Vendor*>(base + head->vendorsOffset), head->vendorCount };
+			ids = { reinterpret_cast<const std::uint32_t*>(base + head->idsOffset), head->idCount };
+			strings = { base + head->stringsOffset, head->stringBytes };
+		}
+
+		bool Valid() const { return header != nullptr; }
+
+		std::span<const Form> Forms() const { return forms; }
+		std::span<const Vendor> Vendors() const { return vendors; }
+
+		const Form* FindForm(std::uint32_t formID) const { return Find(forms, formID); }
+		const Vendor* FindVendor(std::uint32_t formID) const { return Find(vendors, formID); }
+
+		std::span<const std::uint32_t> Ids(Range range) const {
+			if (range.begin > ids.size() || range.count > ids.size() - range.begin) return {};
+			return ids.subspan(range.begin, range.count);
+		}
+
+		std::string_view String(std::uint32_t offset) const {
+			if (offset >= strings.size()) return {};
+			auto text = strings.substr(offset);
+			return text.substr(0, text.find('\0'));
+		}
+
+	private:
+		static bool Fits(size_t size, std::uint64_t offset, std::uint64_t bytes) {
+			return offset % 8 == 0 && offset <= size && bytes <= size - offset;
+		}
+
+		template <class T>
+		static const T* Find(std::span<const T> table, std::uint32_t formID) {
+			auto it = std::ranges::lower_bound(table, formID, {}, &T::formID);
+			return it != table.end() && it->formID == formID ? &*it : nullptr;
+		}
+
+		const Header* header = nullptr;
+		std::span<const Form> forms;
+		std::span<const Vendor> vendors;
+		std::span<const std::uint32_t> ids;
+		std::string_view strings;
+	};
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+// Visits every base form a merchant can stock or the player can sell
+template <class Fn>
+void ForEachTradeableForm(Fn&& fn) {
+	auto dataHandler = RE::TESDataHandler::GetSingleton();
+	if (!dataHandler) return;
+
+	auto visit = [&]<class T>() {
+		for (auto&& form : dataHandler->GetFormArray<T>()) {
+			if (form) fn(static_cast<RE::TESBoundObject*>(form));
+		}
+	};
+	visit.template operator()<RE::TESObjectWEAP>();
+	visit.template operator()<RE::TESObjectARMO>();
+	visit.template operator()<RE::TESAmmo>();
+	visit.template operator()<RE::TESObjectBOOK>();
+	visit.template operator()<RE::TESObjectMISC>();
+	visit.template operator()<RE::TESSoulGem>();
+	visit.template operator()<RE::TESKey>();
+	visit.template operator()<RE::IngredientItem>();
+	visit.template operator()<RE::AlchemyItem>();
+	visit.template operator()<RE::ScrollItem>();
+	visit.template operator()<RE::TESObjectLIGH>();
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "formscan.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Dense indices for the keywords referenced by the config, and per base form a fixed-width bitset of
+// which of them it carries. A keyword test is one bit test instead of a scan of the form's keyword array.
+class KeywordIndex : public SINGLETON<KeywordIndex> {
+public:
+	static constexpr std::uint32_t kNone = UINT32_MAX;
+
+	void Clear() {
+		indices.clear();
+		masks.clear();
+		offsets.clear();
+		words = 0;
+	}
+
+	// Index of `keyword`, assigned on first use. Build() must run again after new keywords were assigned.
+	std::uint32_t Assign(RE::BGSKeyword* keyword) {
+		if (!keyword) return kNone;
+		return indices.try_emplace(keyword->GetFormID(), static_cast<std::uint32_t>(indices.size())).first->second;
+	}
+
+	// Encodes the referenced keywords of every tradeable base form; forms carrying none share the empty mask
+	void Build() {
+		masks.clear();
+		offsets.clear();
+		words = (indices.size() + 63) / 64;
+		if (!words) return;
+
+		masks.assign(words, 0);  // empty mask at offset 0
+		std::vector<std::uint64_t> mask(words);
+		size_t tagged = 0;
+		ForEachTradeableForm([&](RE::TESBoundObject* object) {
+			if (!Encode(object, mask.data())) {
+				offsets[object->GetFormID()] = 0;
+				return;
+			}
+			offsets[object->GetFormID()] = static_cast<std::uint32_t>(masks.size());
+			masks.insert(masks.end(), mask.begin(), mask.end());
+			++tagged;
+		});
+		logger::info("Indexed {} config keywords, {} forms carry at least one ({} KiB of {}-bit masks)",
+			indices.size(), tagged, masks.size() * sizeof(std::uint64_t) / 1024, words * 64);
+	}
+
+	// Keyword mask of a base form, `Words()` wide. Forms outside the scan are encoded on the fly.
+	const std::uint64_t* Mask(RE::TESBoundObject* object) const {
+		if (auto it = offsets.find(object->GetFormID()); it != offsets.end()) return masks.data() + it->second;
+
+		thread_local std::vector<std::uint64_t> scratch;
+		scratch.resize(words);
+		Encode(object, scratch.data());
+		return scratch.data();
+	}
+
+	// Index of an already assigned keyword, kNone otherwise
+	std::uint32_t Find(RE::BGSKeyword* keyword) const {
+		if (!keyword) return kNone;
+		auto it = indices.find(keyword->GetFormID());
+		return it != indices.end() ? it->second : kNone;
+	}
+
+	static bool Test(const std::uint64_t* mask, std::uint32_t index) {
+		return (mask[index / 64] >> (index % 64)) & 1;
+	}
+
+	bool Test(RE::TESBoundObject* object, std::uint32_t index) const {
+		return index / 64 < words && Test(Mask(object), index);
+	}
+
+	size_t Words() const { return words; }
+
+private:
+	bool Encode(RE::TESBoundObject* object, std::uint64_t* mask) const {
+		std::fill_n(mask, words, 0);
+		auto keywordForm = object->As<RE::BGSKeywordForm>();
+		if (!keywordForm) return false;
+
+		bool any = false;
+		for (std::uint32_t k = 0; k < keywordForm->numKeywords; ++k) {
+			auto keyword = keywordForm->keywords[k];
+			if (!keyword) continue;
+			if (auto it = indices.find(keyword->GetFormID()); it != indices.end()) {
+				mask[it->second / 64] |= 1ull << (it->second % 64);
+				any = true;
+			}
+		}
+		return any;
+	}
+
+	std::unordered_map<RE::FormID, std::uint32_t> indices;
+	std::unordered_map<RE::FormID, std::uint32_t> offsets;  // first word of each scanned form's mask
+	std::vector<std::uint64_t> masks;
+	size_t words = 0;
+};
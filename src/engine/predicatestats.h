@@ -0,0 +1,114 @@
+#pragma once
+
+#include "../json.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Per-predicate cost and rejection statistics, keyed by a signature built from the predicate's
+// source text so the learned order survives load order changes and is shared by identical checks.
+class PredicateStats {
+public:
+	static constexpr std::uint32_t kNone = UINT32_MAX;
+	static constexpr std::uint64_t kMinSamples = 32;      // below this the compile-time estimate is used
+	static constexpr std::uint64_t kMaxSamples = 1 << 20; // halve counts past this so old sessions fade
+
+	struct Entry {
+		std::uint64_t evaluations = 0;
+		std::uint64_t rejections = 0;
+		std::uint64_t ticks = 0;
+	};
+
+	std::uint32_t Intern(const std::string& signature) {
+		auto [it, inserted] = ids.try_emplace(signature, static_cast<std::uint32_t>(entries.size()));
+		if (inserted) {
+			entries.emplace_back();
+			signatures.push_back(signature);
+		}
+		return it->second;
+	}
+
+	void Record(std::uint32_t id, std::uint64_t ticks, bool rejected) {
+		auto& e = entries[id];
+		++e.evaluations;
+		e.rejections += rejected;
+		e.ticks += ticks;
+		if (e.evaluations >= kMaxSamples) {
+			e.evaluations /= 2;
+			e.rejections /= 2;
+			e.ticks /= 2;
+		}
+	}
+
+	// Expected cost paid per rejection: cheap, selective checks get the lowest rank and run first
+	double Rank(std::uint32_t id, double defaultCost) const {
+		const auto& e = entries[id];
+		bool learned = e.evaluations >= kMinSamples;
+		double cost = learned ? static_cast<double>(e.ticks) / e.evaluations : defaultCost;
+		double reject = learned ? static_cast<double>(e.rejections) / e.evaluations : 0.5;
+		return cost / std::max(reject, 0.01);
+	}
+
+	const Entry& Get(std::uint32_t id) const { return entries[id]; }
+	const std::string& Signature(std::uint32_t id) const { return signatures[id]; }
+	std::size_t Size() const { return entries.size(); }
+
+	bool Load(const std::filesystem::path& path) {
+		std::ifstream file(path);
+		if (!file.is_open()) {
+			logger::debug("No predicate statistics at {}", path.string());
+			return false;
+		}
+		try {
+			nlohmann::json statsJson;
+			file >> statsJson;
+			if (statsJson.value("version", 0) != kVersion) {
+				logger::info("Ignoring predicate statistics with a different version");
+				return false;
+			}
+			for (auto&& [signature, values] : statsJson["predicates"].items()) {
+				auto& e = entries[Intern(signature)];
+				e.evaluations = values[0].get<std::uint64_t>();
+				e.rejections = values[1].get<std::uint64_t>();
+				e.ticks = values[2].get<std::uint64_t>();
+			}
+			logger::info("Loaded statistics for {} predicates from {}", entries.size(), path.string());
+			return true;
+		} catch (const std::exception& e) {
+			logger::error("Error loading predicate statistics: {}", e.what());
+			return false;
+		}
+	}
+
+	bool Save(const std::filesystem::path& path) const {
+		nlohmann::json statsJson;
+		statsJson["version"] = kVersion;
+		auto& predicates = statsJson["predicates"] = nlohmann::json::object();
+		for (std::size_t i = 0; i < entries.size(); ++i) {
+			if (entries[i].evaluations) predicates[signatures[i]] = { entries[i].evaluations, entries[i].rejections, entries[i].ticks };
+		}
+
+		std::error_code ec;
+		std::filesystem::create_directories(path.parent_path(), ec);
+		std::ofstream file(path);
+		if (!file.is_open()) {
+			logger::error("Failed to write predicate statistics to {}", path.string());
+			return false;
+		}
+		file << statsJson.dump(1, '\t');
+		logger::debug("Saved statistics for {} predicates", predicates.size());
+		return true;
+	}
+
+private:
+	static constexpr int kVersion = 1;
+
+	std::vector<Entry> entries;
+	std::vector<std::string> signatures;
+	std::unordered_map<std::string, std::uint32_t> ids;
+};
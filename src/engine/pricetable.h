@@ -0,0 +1,66 @@
+#pragma once
+
+#include "rulemask.h"
+#include "valuecache.h"
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Buy or sell multipliers of every stack on one side of a barter session, filled by a worker thread.
+// Stacks and their attributes are captured on the main thread and never change afterwards; each price
+// is published through its ready flag, so a reader sees either a finished row or none.
+class PriceTable {
+public:
+	// Attributes of one stack as the item filters read them
+	struct Item {
+		RE::TESBoundObject* object;
+		float weight;
+		float value;
+	};
+
+	struct Price {
+		float fixed = 1.0f;  // product of every matching fixed-value entry, static table included
+		RuleMask ranged;     // matching entries whose value is rolled
+	};
+
+	explicit PriceTable(RE::FormID trader) : trader(trader) {}
+
+	void Add(ValueCache::Key key, const Item& item) {
+		if (index.try_emplace(key, items.size()).second) items.push_back(item);
+	}
+
+	// Ends the capture; rows can be published from here on
+	void Seal() {
+		prices.resize(items.size());
+		ready = std::make_unique<std::atomic<bool>[]>(items.size());
+	}
+
+	size_t Size() const { return items.size(); }
+	const Item& At(size_t i) const { return items[i]; }
+	RE::FormID Trader() const { return trader; }
+
+	void Publish(size_t i, Price&& price) {
+		prices[i] = std::move(price);
+		ready[i].store(true, std::memory_order_release);
+	}
+
+	// Finished price of a stack, null when it was not captured or is not computed yet
+	const Price* Find(const ValueCache::Key& key) const {
+		auto it = index.find(key);
+		if (it == index.end() || !ready[it->second].load(std::memory_order_acquire)) return nullptr;
+		return &prices[it->second];
+	}
+
+	void Cancel() { cancelled.store(true, std::memory_order_relaxed); }
+	bool Cancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+private:
+	RE::FormID trader;
+	std::unordered_map<ValueCache::Key, size_t, ValueCache::KeyHash> index;
+	std::vector<Item> items;
+	std::vector<Price> prices;
+	std::unique_ptr<std::atomic<bool>[]> ready;
+	std::atomic<bool> cancelled = false;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "telemetry.h"
+
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+// Relationship rank per (player NPC, merchant NPC) pair. The engine resolves it through the relationship
+// index of both NPCs on every query; the pair is fixed while trading, so each one is looked up once.
+// Ranks only change through scripts, so the cache is dropped on game load and quest stage changes. A
+// SetRelationshipRank call outside a quest stage raises no event, so the pair of a merchant is also
+// looked up again whenever a barter with it starts. Across sessions the cache therefore only serves
+// restocks (inline and deferred, and the ranks Prewarm resolves for them); within a session it serves
+// the price tables and every price call after the first.
+class RelationshipCache : public SINGLETON<RelationshipCache> {
+public:
+	int Get(RE::TESNPC* player, RE::TESNPC* npc) {
+		const auto key = Key(player, npc);
+		{
+			std::shared_lock lock(mutex);
+			if (auto it = ranks.find(key); it != ranks.end()) {
+				Telemetry::getInstance()->RecordCache(Telemetry::Cache::Relationship, true);
+				return it->second;
+			}
+		}
+		Telemetry::getInstance()->RecordCache(Telemetry::Cache::Relationship, false);
+		int rank = Lookup(player, npc);
+		std::unique_lock lock(mutex);
+		ranks.emplace(key, rank);
+		return rank;
+	}
+
+	int Get(RE::Actor* trader) {
+		return Get(RE::PlayerCharacter::GetSingleton()->GetActorBase(), trader->GetActorBase());
+	}
+
+	// Resolves the rank of every merchant loaded in `cell`, returns how many were looked up
+	size_t Prewarm(RE::TESObjectCELL* cell) {
+		auto player = RE::PlayerCharacter::GetSingleton();
+		if (!cell || !player) return 0;
+
+		auto playerBase = player->GetActorBase();
+		std::vector<RE::TESNPC*> merchants;
+		cell->ForEachReference([&](RE::TESObjectREFR* ref) {
+			auto actor = ref ? ref->As<RE::Actor>() : nullptr;
+			if (actor && actor != player && actor->GetVendorFaction()) {
+				if (auto npc = actor->GetActorBase()) merchants.push_back(npc);
+			}
+			return RE::BSContainer::ForEachResult::kContinue;
+		});
+
+		size_t resolved = 0;
+		for (auto npc : merchants) {
+			const auto key = Key(playerBase, npc);
+			{
+				std::shared_lock lock(mutex);
+				if (ranks.contains(key)) continue;
+			}
+			int rank = Lookup(playerBase, npc);
+			std::unique_lock lock(mutex);
+			ranks.emplace(key, rank);
+			++resolved;
+		}
+		logger::debug("Prewarmed relationship ranks of {} merchants in {} ({} already cached)",
+			resolved, cell->GetFormEditorID(), merchants.size() - resolved);
+		return resolved;
+	}
+
+	// Drops the pair of the player and `trader`
+	void Invalidate(RE::Actor* trader) {
+		auto player = RE::PlayerCharacter::GetSingleton();
+		if (!trader || !player || !trader->GetActorBase()) return;
+		const auto key = Key(player->GetActorBase(), trader->GetActorBase());
+		std::unique_lock lock(mutex);
+		ranks.erase(key);
+	}
+
+	void Invalidate(const char* reason) {
+		std::unique_lock lock(mutex);
+		if (ranks.empty()) return;
+		logger::debug("Dropped {} cached relationship ranks: {}", ranks.size(), reason);
+		ranks.clear();
+	}
+
+	static int Lookup(RE::TESNPC* player, RE::TESNPC* npc) {
+		static REL::Relocation<int (*)(RE::TESNPC*, RE::TESNPC*)> getidx(RELOCATION_ID(24076, 24076));
+		static REL::Relocation<int*> idxmap(RELOCATION_ID(369311, 369311));
+		return idxmap.get()[getidx(player, npc)];
+	}
+
+private:
+	static std::uint64_t Key(RE::TESNPC* player, RE::TESNPC* npc) {
+		return (static_cast<std::uint64_t>(player->GetFormID()) << 32) | npc->GetFormID();
+	}
+
+	std::shared_mutex mutex;
+	std::unordered_map<std::uint64_t, int> ranks;
+};
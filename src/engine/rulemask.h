@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+// Dynamically sized bitset used for rule/row match masks
+class RuleMask {
+public:
+	RuleMask() = default;
+	explicit RuleMask(std::size_t bits) { Resize(bits); }
+
+	void Resize(std::size_t bits) {
+		size = bits;
+		words.assign((bits + 63) / 64, 0);
+	}
+
+	std::size_t Size() const { return size; }
+	std::size_t WordCount() const { return words.size(); }
+	std::uint64_t* Data() { return words.data(); }
+	const std::uint64_t* Data() const { return words.data(); }
+
+	void Clear() { std::fill(words.begin(), words.end(), 0); }
+	void SetAll() {
+		std::fill(words.begin(), words.end(), ~0ull);
+		TrimTail();
+	}
+
+	void Set(std::size_t i) { words[i >> 6] |= 1ull << (i & 63); }
+	void Reset(std::size_t i) { words[i >> 6] &= ~(1ull << (i & 63)); }
+	bool Test(std::size_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+
+	// Sets bits [i, i + n) from the low n bits of v (n <= 64)
+	void SetBits(std::size_t i, std::uint64_t v, std::size_t n) {
+		if (n < 64) v &= (1ull << n) - 1;
+		std::size_t w = i >> 6, off = i & 63;
+		words[w] |= v << off;
+		if (off && off + n > 64 && w + 1 < words.size()) words[w + 1] |= v >> (64 - off);
+	}
+
+	RuleMask& operator&=(const RuleMask& other) {
+		for (std::size_t i = 0; i < words.size() && i < other.words.size(); ++i) words[i] &= other.words[i];
+		return *this;
+	}
+
+	RuleMask& operator|=(const RuleMask& other) {
+		for (std::size_t i = 0; i < words.size() && i < other.words.size(); ++i) words[i] |= other.words[i];
+		return *this;
+	}
+
+	bool operator==(const RuleMask& other) const = default;
+
+	// True when every bit set in `subset` is also set here
+	bool Contains(const RuleMask& subset) const {
+		for (std::size_t i = 0; i < subset.words.size(); ++i) {
+			std::uint64_t mine = i < words.size() ? words[i] : 0;
+			if ((subset.words[i] & mine) != subset.words[i]) return false;
+		}
+		return true;
+	}
+
+	bool Any() const {
+		for (auto w : words) if (w) return true;
+		return false;
+	}
+
+	std::size_t Count() const {
+		std::size_t n = 0;
+		for (auto w : words) n += std::popcount(w);
+		return n;
+	}
+
+	// Calls fn(index) for every set bit in ascending order
+	template <class Fn>
+	void ForEach(Fn&& fn) const {
+		for (std::size_t w = 0; w < words.size(); ++w) {
+			std::uint64_t bits = words[w];
+			while (bits) {
+				fn((w << 6) + std::countr_zero(bits));
+				bits &= bits - 1;
+			}
+		}
+	}
+
+private:
+	void TrimTail() {
+		if (size & 63) words.back() &= (1ull << (size & 63)) - 1;
+	}
+
+	std::vector<std::uint64_t> words;
+	std::size_t size = 0;
+};
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#	include <intrin.h>
+#else
+#	include <x86intrin.h>
+#endif
+
+// Sampling profiler for rule evaluation. Timing every rule would cost more than most rules do, so only
+// about one in `ruleEvery` rule evaluations is timed (at random intervals, so no rule is favoured by the
+// order of a section) and one in `callEvery` full calls. Sampled costs are scaled by their sampling rate
+// into estimated totals; a rule whose estimated total exceeds the budget is flagged once.
+// Rules far slower than the rest of their section, or expensive while almost never matching, are
+// reported once as findings. Used from the main thread only.
+class RuleProfiler {
+public:
+	static constexpr std::uint64_t kMinSamples = 32;  // findings are checked at 32, 256 and 2048 samples
+	static constexpr double kSlowFactor = 8.0;        // mean cost vs. the section's mean cost per evaluation
+	static constexpr double kSlowFloorNs = 250.0;     // cheaper than this is never slow
+	static constexpr double kRareMatch = 0.01;        // match rate below which a costly rule is inefficient
+	static constexpr double kCostlyFactor = 2.0;
+
+	enum class Finding : std::uint8_t { Slow, Inefficient };
+
+	struct Rule {
+		std::uint64_t samples = 0;
+		std::uint64_t ticks = 0;
+		std::uint64_t hits = 0;  // sampled evaluations that matched
+		bool flagged = false;
+		bool reported = false;
+	};
+
+	struct Suspect {
+		size_t section;
+		size_t entry;
+		Finding finding;
+	};
+
+	struct Calls {
+		std::uint64_t calls = 0;
+		std::uint64_t samples = 0;
+		std::uint64_t ticks = 0;
+	};
+
+	void Configure(std::uint32_t ruleEvery, std::uint32_t callEvery, double budgetMs, const std::array<size_t, 3>& entries) {
+		this->ruleEvery = ruleEvery;
+		this->callEvery = callEvery;
+		budgetNs = budgetMs * 1e6;
+		for (size_t k = 0; k < 3; ++k) rules[k].assign(entries[k], {});
+		suspects.clear();
+		Reset();
+	}
+
+	void Reset() {
+		for (auto& section : rules) {
+			for (auto& rule : section) rule = Rule{ .reported = rule.reported };
+		}
+		calls = {};
+		sectionTicks = {};
+		sectionSamples = {};
+		untilCall = callEvery ? callEvery : UINT64_MAX;
+		sinceCalibration = 0;
+		untilRule = Skip();
+		calibrationTicks = __rdtsc();
+		calibrationTime = std::chrono::steady_clock::now();
+	}
+
+	bool Enabled() const { return ruleEvery || callEvery; }
+
+	// Counts a call and tells whether it is timed as a whole. Sampling off only means countdowns that never
+	// run out, so a disabled profiler costs a call what an enabled one does between samples.
+	bool SampleCall(size_t k) {
+		++calls[k].calls;
+		if (--untilCall) return false;
+		untilCall = callEvery;
+		return true;
+	}
+
+	void RecordCall(size_t k, std::uint64_t ticks) {
+		++calls[k].samples;
+		calls[k].ticks += ticks;
+	}
+
+	// True when one of the next `evaluations` rule evaluations is due for timing; otherwise skips past them
+	bool RulesDue(std::uint64_t evaluations) {
+		if (untilRule > evaluations) {
+			untilRule -= evaluations;
+			return false;
+		}
+		return true;
+	}
+
+	// Per evaluation while RulesDue() held: tells whether this one is timed
+	bool SampleRule() {
+		if (--untilRule) return false;
+		untilRule = Skip();
+		return true;
+	}
+
+	// Interpreted evaluation of `entries` with the due ones timed: match(i) evaluates entry i, onMatch(i)
+	// takes every entry that matched. `rulesDue` is RulesDue(entries.size()) of this call. Timed and
+	// untimed evaluations run through the same loop, so a sampled call keeps the branch history of the
+	// unsampled ones and costs only its timed evaluations more.
+	template <class Match, class OnMatch>
+	void Evaluate(size_t k, const std::vector<size_t>& entries, bool rulesDue, Match&& match, OnMatch&& onMatch) {
+		// Position in `entries` of the next timed evaluation, past the end when none is left in this call
+		size_t timed = rulesDue ? static_cast<size_t>(untilRule - 1) : entries.size();
+		for (size_t n = 0; n < entries.size(); ++n) {
+			const size_t i = entries[n];
+			const bool timing = n == timed;
+			const std::uint64_t start = timing ? __rdtsc() : 0;
+			const bool hit = match(i);
+			if (timing) [[unlikely]] {
+				RecordRule(k, i, __rdtsc() - start, hit);
+				untilRule = Skip();
+				timed = n + static_cast<size_t>(untilRule);
+			}
+			if (hit) onMatch(i);
+		}
+		if (rulesDue) untilRule = timed + 1 - entries.size();
+	}
+
+	void RecordRule(size_t k, size_t i, std::uint64_t ticks, bool hit) {
+		if (i >= rules[k].size()) return;
+		auto& rule = rules[k][i];
+		++rule.samples;
+		rule.ticks += ticks;
+		rule.hits += hit;
+		sectionTicks[k] += ticks;
+		++sectionSamples[k];
+		if (!rule.flagged && rule.ticks > BudgetTicks()) {
+			rule.flagged = true;
+			flaggedNow.push_back({ k, i });
+		}
+		if (!rule.reported && (rule.samples == kMinSamples || rule.samples == kMinSamples * 8 || rule.samples == kMinSamples * 64)) Inspect(k, i);
+	}
+
+	// Whether TakeFlagged() or TakeSuspects() has anything, so callers skip both in the common case
+	bool HasFindings() const { return !flaggedNow.empty() || !suspects.empty(); }
+
+	// Rules flagged since the last call, as (section, entry)
+	std::vector<std::pair<size_t, size_t>> TakeFlagged() { return std::exchange(flaggedNow, {}); }
+
+	// Findings since the last call; each rule is reported at most once per config load
+	std::vector<Suspect> TakeSuspects() { return std::exchange(suspects, {}); }
+
+	// Mean cost of one evaluation across every sampled rule of a section
+	double SectionMeanNs(size_t k) const { return sectionSamples[k] ? sectionTicks[k] / TicksPerNs() / sectionSamples[k] : 0.0; }
+	double MatchRate(const Rule& rule) const { return rule.samples ? static_cast<double>(rule.hits) / rule.samples : 0.0; }
+
+	// Estimated cumulative cost of every evaluation of a rule in this window, from its samples
+	double EstimatedNs(const Rule& rule) const { return rule.ticks * ruleEvery / TicksPerNs(); }
+	double EstimatedCallNs(size_t k) const {
+		const auto& c = calls[k];
+		return c.samples ? static_cast<double>(c.ticks) / TicksPerNs() * c.calls / c.samples : 0.0;
+	}
+	double MeanNs(const Rule& rule) const { return rule.samples ? rule.ticks / TicksPerNs() / rule.samples : 0.0; }
+
+	const std::vector<Rule>& Rules(size_t k) const { return rules[k]; }
+	const Calls& CallStats(size_t k) const { return calls[k]; }
+	std::uint32_t RuleEvery() const { return ruleEvery; }
+	std::uint32_t CallEvery() const { return callEvery; }
+	double BudgetMs() const { return budgetNs / 1e6; }
+
+	// TSC rate measured over the window so far; timing is in TSC ticks as in the predicate statistics
+	double TicksPerNs() const {
+		const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - calibrationTime).count();
+		const double ticks = static_cast<double>(__rdtsc() - calibrationTicks);
+		return ns > 1e6 && ticks > 0.0 ? ticks / ns : 1.0;
+	}
+
+private:
+	// Sampled ticks of one rule that estimate the whole budget, for the check of every sample. The TSC rate
+	// behind it is re-measured every kCalibrateEvery samples: reading the clock costs more than a sample
+	static constexpr std::uint32_t kCalibrateEvery = 256;
+	double BudgetTicks() {
+		if (sinceCalibration++ % kCalibrateEvery == 0) {
+			const double ticksPerNs = TicksPerNs();
+			budgetTicks = budgetNs * ticksPerNs / ruleEvery;
+			if (ticksPerNs == 1.0) sinceCalibration = 0;  // window still under a millisecond, no rate yet
+		}
+		return budgetTicks;
+	}
+
+	void Inspect(size_t k, size_t i) {
+		auto& rule = rules[k][i];
+		const double mean = MeanNs(rule);
+		const double sectionMean = SectionMeanNs(k);
+		if (mean >= kSlowFloorNs && mean > kSlowFactor * sectionMean) {
+			suspects.push_back({ k, i, Finding::Slow });
+		} else if (mean >= kSlowFloorNs / 2 && mean > kCostlyFactor * sectionMean && MatchRate(rule) < kRareMatch) {
+			suspects.push_back({ k, i, Finding::Inefficient });
+		} else {
+			return;
+		}
+		rule.reported = true;
+	}
+
+	// Evaluations until the next timed one: uniform in [1, 2 * ruleEvery - 1], one in ruleEvery on average
+	std::uint64_t Skip() {
+		if (!ruleEvery) return UINT64_MAX;
+		rng ^= rng << 13;
+		rng ^= rng >> 7;
+		rng ^= rng << 17;
+		return 1 + (((rng >> 32) * (2ull * ruleEvery - 1)) >> 32);
+	}
+
+	std::uint32_t ruleEvery = 0;
+	std::uint32_t callEvery = 0;
+	double budgetNs = 0.0;
+	std::array<std::vector<Rule>, 3> rules;
+	std::array<Calls, 3> calls{};
+	std::vector<std::pair<size_t, size_t>> flaggedNow;
+	std::vector<Suspect> suspects;
+	std::array<std::uint64_t, 3> sectionTicks{};
+	std::array<std::uint64_t, 3> sectionSamples{};
+	std::uint64_t untilCall = UINT64_MAX;
+	std::uint64_t untilRule = UINT64_MAX;
+	std::uint64_t rng = 0x9E3779B97F4A7C15ull;
+	std::uint64_t calibrationTicks = 0;
+	std::chrono::steady_clock::time_point calibrationTime;
+	std::uint32_t sinceCalibration = 0;
+	double budgetTicks = 0.0;
+};
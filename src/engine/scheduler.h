@@ -0,0 +1,139 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <string>
+#include <utility>
+
+// Main-thread work that may be spread across frames, written as a C++20 coroutine.
+// A task starts suspended and only runs from Scheduler::RunFrame.
+class FrameTask {
+public:
+	struct promise_type {
+		FrameTask get_return_object() { return FrameTask{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() {
+			try {
+				std::rethrow_exception(std::current_exception());
+			} catch (const std::exception& e) {
+				logger::error("Deferred task failed: {}", e.what());
+			} catch (...) {
+				logger::error("Deferred task failed");
+			}
+		}
+	};
+
+	FrameTask() = default;
+	FrameTask(FrameTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+	FrameTask& operator=(FrameTask&& other) noexcept {
+		if (this != &other) {
+			if (handle) handle.destroy();
+			handle = std::exchange(other.handle, {});
+		}
+		return *this;
+	}
+	FrameTask(const FrameTask&) = delete;
+	FrameTask& operator=(const FrameTask&) = delete;
+	~FrameTask() {
+		if (handle) handle.destroy();
+	}
+
+	// Runs until the next suspension point, returns true once the coroutine finished
+	bool Resume() {
+		if (handle && !handle.done()) handle.resume();
+		return !handle || handle.done();
+	}
+
+private:
+	explicit FrameTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+	std::coroutine_handle<promise_type> handle;
+};
+
+// Cooperative scheduler for FrameTasks, driven once per frame from the main update hook.
+// Tasks `co_await Scheduler::Budget{}` between steps: that is free while the frame budget lasts and
+// otherwise parks the task until the next frame. Tasks are only spawned and run on the main thread.
+class Scheduler : public SINGLETON<Scheduler> {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Budget {
+		bool await_ready() const noexcept { return !Scheduler::getInstance()->Expired(); }
+		void await_suspend(std::coroutine_handle<>) const noexcept {}
+		void await_resume() const noexcept {}
+	};
+
+	void SetBudget(double ms) {
+		budget = ms;
+		logger::debug("Deferred work budget set to {:.3f} ms per frame", ms);
+	}
+
+	void Spawn(std::string name, FrameTask&& task) {
+		logger::trace("Queued deferred task '{}'", name);
+		queue.push_back({ std::move(name), std::move(task) });
+		maxDepth = std::max(maxDepth, queue.size());
+	}
+
+	void RunFrame() {
+		++frames;
+		if (queue.empty()) return;
+
+		const auto start = Clock::now();
+		deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(budget));
+		do {
+			auto entry = std::move(queue.front());
+			queue.pop_front();
+			if (entry.task.Resume()) {
+				++completed;
+				logger::trace("Deferred task '{}' finished", entry.name);
+			} else {
+				queue.push_back(std::move(entry));
+			}
+		} while (!queue.empty() && !Expired());
+		deadline = Clock::time_point::max();
+
+		const double spent = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		if (spent > budget) {
+			++overruns;
+			worstOverrun = std::max(worstOverrun, spent - budget);
+		}
+		if (frames - lastReport >= kReportInterval) Report();
+	}
+
+	bool Expired() const { return Clock::now() >= deadline; }
+
+	size_t Depth() const { return queue.size(); }
+	size_t MaxDepth() const { return maxDepth; }
+	std::uint64_t Completed() const { return completed; }
+	std::uint64_t Overruns() const { return overruns; }
+	double WorstOverrun() const { return worstOverrun; }
+
+	void Report() {
+		lastReport = frames;
+		if (!completed && queue.empty()) return;
+		logger::info("Deferred work: queue depth {} (max {}), {} tasks finished, {} budget overruns (worst +{:.3f} ms over {:.3f} ms)",
+			queue.size(), maxDepth, completed, overruns, worstOverrun, budget);
+	}
+
+private:
+	static constexpr std::uint64_t kReportInterval = 3600;  // frames, about a minute
+
+	struct Entry {
+		std::string name;
+		FrameTask task;
+	};
+
+	std::deque<Entry> queue;
+	double budget = 0.5;
+	Clock::time_point deadline = Clock::time_point::max();  // outside RunFrame tasks are not running
+	std::uint64_t frames = 0;
+	std::uint64_t lastReport = 0;
+	std::uint64_t completed = 0;
+	std::uint64_t overruns = 0;
+	double worstOverrun = 0.0;
+	size_t maxDepth = 0;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../json.hpp"
+
+// Optional "Engine" object of a config file, tuning how rules are evaluated rather than what they do
+struct EngineSettings {
+	bool jit = true;               // compile large sections to native code
+	std::size_t jitMinEntries = 64; // sections smaller than this stay on the bytecode interpreter
+	bool benchmark = false;        // time the evaluators after a save is loaded
+	bool backgroundPrices = true;  // price both sides of a barter on a worker thread when the menu opens
+	double frameBudgetMs = 0.5;    // main-thread time per frame for deferred work (prewarming, off-target restocks, stats)
+	std::size_t workerThreads = 0; // background worker threads, 0 = two fewer than the cores; always below the core count
+	std::size_t traceEvents = 0;   // spans kept for the Chrome trace written by "scs trace", 0 = tracing off
+	std::uint32_t profileRuleEvery = 2048; // time one in this many rule evaluations, 0 = off
+	std::uint32_t profileCallEvery = 64;   // time one in this many full calls, 0 = off
+	double profileBudgetMs = 250.0;        // flag a rule once its estimated cost since the last stats reset exceeds this
+
+	void Parse(const nlohmann::json& engineJson) {
+		logger::trace("Parsing engine settings");
+		jit = engineJson.value("JIT", jit);
+		jitMinEntries = engineJson.value("JITMinEntries", jitMinEntries);
+		benchmark = engineJson.value("Benchmark", benchmark);
+		backgroundPrices = engineJson.value("BackgroundPrices", backgroundPrices);
+		frameBudgetMs = engineJson.value("FrameBudgetMs", frameBudgetMs);
+		workerThreads = engineJson.value("WorkerThreads", workerThreads);
+		traceEvents = engineJson.value("TraceEvents", traceEvents);
+		profileRuleEvery = engineJson.value("ProfileRuleEvery", profileRuleEvery);
+		profileCallEvery = engineJson.value("ProfileCallEvery", profileCallEvery);
+		profileBudgetMs = engineJson.value("ProfileBudgetMs", profileBudgetMs);
+		logger::debug("Engine settings - JIT: {} (min {} entries), Benchmark: {}, BackgroundPrices: {}, FrameBudgetMs: {}, WorkerThreads: {}, TraceEvents: {}",
+			jit, jitMinEntries, benchmark, backgroundPrices, frameBudgetMs, workerThreads, traceEvents);
+		logger::debug("Engine settings - ProfileRuleEvery: {}, ProfileCallEvery: {}, ProfileBudgetMs: {}", profileRuleEvery, profileCallEvery, profileBudgetMs);
+	}
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Two-level radix table from FormID to a folded multiplier.
+// Level one is the plugin slot (full plugins by load index, light plugins by their 12-bit index),
+// level two a dense array over the plugin's local FormID range holding indices into a palette of
+// distinct products, so a lookup is two array reads.
+class StaticMultiplierTable {
+public:
+	void Clear() {
+		pages.clear();
+		palette.clear();
+		staged.clear();
+	}
+
+	// Stages a value, Finalize() builds the table
+	void Insert(std::uint32_t formID, float product) {
+		if (Slot(formID) < kSlots) staged.emplace_back(formID, product);
+	}
+
+	void Finalize() {
+		pages.assign(kSlots, {});
+		palette.clear();
+		std::unordered_map<float, std::uint16_t> paletteIndex;
+
+		// ascending FormIDs so every page only grows at the back
+		std::sort(staged.begin(), staged.end());
+		for (auto&& [formID, product] : staged) {
+			auto& page = pages[Slot(formID)];
+			std::uint32_t local = Local(formID);
+			if (page.index.empty()) {
+				page.base = local;
+				page.index.resize(1, 0);
+			} else if (local - page.base >= page.index.size()) {
+				page.index.resize(local - page.base + 1, 0);
+			}
+
+			auto [it, inserted] = paletteIndex.try_emplace(product, static_cast<std::uint16_t>(palette.size() + 1));
+			if (inserted) {
+				if (palette.size() + 1 >= UINT16_MAX) {
+					paletteIndex.erase(it);
+					continue;  // palette full, leave the form to the rule loop
+				}
+				palette.push_back(product);
+			}
+			page.index[local - page.base] = it->second;
+		}
+		staged.clear();
+		staged.shrink_to_fit();
+	}
+
+	std::optional<float> Lookup(std::uint32_t formID) const {
+		std::uint32_t slot = Slot(formID);
+		if (slot >= pages.size()) return std::nullopt;
+		const auto& page = pages[slot];
+		std::uint32_t offset = Local(formID) - page.base;
+		if (offset >= page.index.size() || !page.index[offset]) return std::nullopt;
+		return palette[page.index[offset] - 1];
+	}
+
+	std::size_t Forms() const {
+		std::size_t n = 0;
+		for (auto&& page : pages) {
+			for (auto idx : page.index) n += idx != 0;
+		}
+		return n;
+	}
+
+	std::size_t Products() const { return palette.size(); }
+
+	std::size_t Bytes() const {
+		std::size_t n = pages.size() * sizeof(Page) + palette.size() * sizeof(float);
+		for (auto&& page : pages) n += page.index.size() * sizeof(std::uint16_t);
+		return n;
+	}
+
+private:
+	static constexpr std::uint32_t kFullSlots = 0xFE;
+	static constexpr std::uint32_t kSlots = kFullSlots + 0x1000;
+
+	// 0xFE light plugins get their own slots, 0xFF (runtime forms) maps past the end
+	static std::uint32_t Slot(std::uint32_t formID) {
+		std::uint32_t file = formID >> 24;
+		if (file < kFullSlots) return file;
+		if (file == 0xFE) return kFullSlots + ((formID >> 12) & 0xFFF);
+		return kSlots;
+	}
+
+	static std::uint32_t Local(std::uint32_t formID) {
+		return (formID >> 24) == 0xFE ? formID & 0xFFF : formID & 0xFFFFFF;
+	}
+
+	struct Page {
+		std::uint32_t base = 0;
+		std::vector<std::uint16_t> index;  // 0 = not folded, otherwise palette index + 1
+	};
+
+	std::vector<Page> pages;
+	std::vector<float> palette;
+	std::vector<std::pair<std::uint32_t, float>> staged;
+};
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Build with STOCKCONTROL_TELEMETRY=0 to compile the counters and timers out of the hot paths
+#ifndef STOCKCONTROL_TELEMETRY
+#	define STOCKCONTROL_TELEMETRY 1
+#endif
+
+// Log-linear latency histogram in nanoseconds: 16 sub-buckets per power of two, so any
+// recorded value is reported within about 6% while the whole range up to ~18 minutes fits 600 buckets.
+struct LatencyBuckets {
+	static constexpr std::uint32_t kSubBits = 4;
+	static constexpr std::uint32_t kSub = 1u << kSubBits;
+	static constexpr std::uint32_t kMaxExponent = 39;
+	static constexpr std::size_t kBuckets = (kMaxExponent - kSubBits + 2) * kSub;
+
+	static std::size_t Index(std::uint64_t ns) {
+		if (ns < kSub) return static_cast<std::size_t>(ns);
+		std::uint32_t exponent = std::min<std::uint32_t>(std::bit_width(ns) - 1, kMaxExponent);
+		std::uint64_t sub = ns >> (exponent - kSubBits) & (kSub - 1);
+		return (exponent - kSubBits + 1) * kSub + static_cast<std::size_t>(sub);
+	}
+
+	// Upper bound of a bucket, the value percentiles report
+	static std::uint64_t Upper(std::size_t index) {
+		if (index < kSub) return index;
+		std::uint32_t exponent = static_cast<std::uint32_t>(index / kSub) + kSubBits - 1;
+		std::uint64_t sub = index % kSub;
+		return ((kSub + sub + 1) << (exponent - kSubBits)) - 1;
+	}
+};
+
+// Merged view of every thread's counters, taken on demand
+struct TelemetrySnapshot {
+	struct Rule {
+		std::uint64_t evaluations = 0;
+		std::uint64_t matches = 0;
+	};
+
+	struct Histogram {
+		std::array<std::uint64_t, LatencyBuckets::kBuckets> buckets{};
+		std::uint64_t count = 0;
+		std::uint64_t totalNs = 0;
+		std::uint64_t maxNs = 0;
+
+		std::uint64_t Percentile(double q) const {
+			if (!count) return 0;
+			const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(count - 1)) + 1;
+			std::uint64_t seen = 0;
+			for (std::size_t i = 0; i < buckets.size(); ++i) {
+				seen += buckets[i];
+				if (seen >= rank) return std::min(LatencyBuckets::Upper(i), maxNs);
+			}
+			return maxNs;
+		}
+
+		double MeanNs() const { return count ? static_cast<double>(totalNs) / count : 0.0; }
+	};
+
+	struct Cache {
+		std::uint64_t hits = 0;
+		std::uint64_t misses = 0;
+
+		double HitRate() const { return hits + misses ? 100.0 * hits / (hits + misses) : 0.0; }
+	};
+
+	std::array<std::vector<Rule>, 3> rules;  // buy, sell, count; indexed like the section's entries
+	std::array<Histogram, 4> latency;        // indexed by Telemetry::Probe
+	std::array<Cache, 3> caches;             // indexed by Telemetry::Cache
+	std::array<std::uint64_t, 3> events{};   // indexed by Telemetry::Event
+	std::size_t threads = 0;
+};
+
+// Per-rule evaluation/match counts, per-entry-point latency histograms, cache hit/miss and restock counts.
+// Each recording thread owns a cache-line aligned slot and is its only writer, so a record is a plain
+// relaxed load and store; Merge() sums the slots when asked. Slots outlive their threads.
+class Telemetry : public SINGLETON<Telemetry> {
+public:
+	static constexpr bool kEnabled = STOCKCONTROL_TELEMETRY;
+
+	enum class Probe : std::uint8_t { BuyPrice, SellPrice, RestockItems, InitLeveledItems, kTotal };
+	static constexpr std::size_t kProbes = static_cast<std::size_t>(Probe::kTotal);
+	static constexpr const char* kProbeNames[kProbes] = { "GetBuyPriceMultiplier", "GetSellPriceMultiplier", "RestockItems", "InitLeveledItems" };
+
+	enum class Cache : std::uint8_t { ItemValue, Relationship, PriceTable, kTotal };
+	static constexpr std::size_t kCaches = static_cast<std::size_t>(Cache::kTotal);
+	static constexpr const char* kCacheNames[kCaches] = { "item values", "relationship ranks", "price tables" };
+
+	enum class Event : std::uint8_t { Restock, DeferredRestock, RestockedStack, kTotal };
+	static constexpr std::size_t kEvents = static_cast<std::size_t>(Event::kTotal);
+	static constexpr const char* kEventNames[kEvents] = { "restocks", "deferred restocks", "restocked stacks" };
+
+	// Times its scope into the histogram of `probe`
+	class Timer {
+	public:
+#if STOCKCONTROL_TELEMETRY
+		explicit Timer(Probe probe) : probe(probe), start(std::chrono::steady_clock::now()) {}
+		~Timer() {
+			const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			Telemetry::getInstance()->RecordLatency(probe, static_cast<std::uint64_t>(ns));
+		}
+
+	private:
+		Probe probe;
+		std::chrono::steady_clock::time_point start;
+#else
+		explicit Timer(Probe) {}
+#endif
+	};
+
+	// Rule counts restart whenever entries are rebuilt, as their indices change
+	void Configure(const std::array<std::size_t, 3>& entries) {
+		if constexpr (!kEnabled) return;
+		std::lock_guard lock(mutex);
+		layout = entries;
+		generation.fetch_add(1, std::memory_order_release);
+	}
+
+	// One evaluation of every entry in `entries` of section `k`, matching where `matched` is set
+	template <class Entries, class Mask>
+	void RecordRules(std::size_t k, const Entries& entries, const Mask& matched) {
+		if constexpr (!kEnabled) return;
+		auto& slot = Local();
+		auto& counters = slot.rules[k];
+		for (std::size_t i : entries) {
+			if (i >= counters.size) continue;
+			Bump(counters.data[i].evaluations);
+			if (matched.Test(i)) Bump(counters.data[i].matches);
+		}
+	}
+
+	void RecordLatency(Probe probe, std::uint64_t ns) {
+		if constexpr (!kEnabled) return;
+		auto& histogram = Local().latency[static_cast<std::size_t>(probe)];
+		Bump(histogram.buckets[LatencyBuckets::Index(ns)]);
+		Bump(histogram.count);
+		Bump(histogram.totalNs, ns);
+		if (ns > histogram.maxNs.load(std::memory_order_relaxed)) histogram.maxNs.store(ns, std::memory_order_relaxed);
+	}
+
+	void RecordCache(Cache cache, bool hit) {
+		if constexpr (!kEnabled) return;
+		auto& counters = Local().caches[static_cast<std::size_t>(cache)];
+		Bump(hit ? counters.hits : counters.misses);
+	}
+
+	void Count(Event event, std::uint64_t n = 1) {
+		if constexpr (!kEnabled) return;
+		Bump(Local().events[static_cast<std::size_t>(event)], n);
+	}
+
+	TelemetrySnapshot Merge() {
+		TelemetrySnapshot snapshot;
+		if constexpr (!kEnabled) return snapshot;
+		std::lock_guard lock(mutex);
+		for (std::size_t k = 0; k < 3; ++k) snapshot.rules[k].resize(layout[k]);
+		for (auto& slot : slots) {
+			std::lock_guard slotLock(slot->mutex);
+			if (slot->generation == generation.load(std::memory_order_acquire)) {
+				for (std::size_t k = 0; k < 3; ++k) {
+					for (std::size_t i = 0; i < slot->rules[k].size && i < layout[k]; ++i) {
+						snapshot.rules[k][i].evaluations += slot->rules[k].data[i].evaluations.load(std::memory_order_relaxed);
+						snapshot.rules[k][i].matches += slot->rules[k].data[i].matches.load(std::memory_order_relaxed);
+					}
+				}
+			}
+			for (std::size_t p = 0; p < kProbes; ++p) {
+				const auto& from = slot->latency[p];
+				auto& into = snapshot.latency[p];
+				for (std::size_t b = 0; b < LatencyBuckets::kBuckets; ++b) into.buckets[b] += from.buckets[b].load(std::memory_order_relaxed);
+				into.count += from.count.load(std::memory_order_relaxed);
+				into.totalNs += from.totalNs.load(std::memory_order_relaxed);
+				into.maxNs = std::max(into.maxNs, from.maxNs.load(std::memory_order_relaxed));
+			}
+			for (std::size_t c = 0; c < kCaches; ++c) {
+				snapshot.caches[c].hits += slot->caches[c].hits.load(std::memory_order_relaxed);
+				snapshot.caches[c].misses += slot->caches[c].misses.load(std::memory_order_relaxed);
+			}
+			for (std::size_t e = 0; e < kEvents; ++e) snapshot.events[e] += slot->events[e].load(std::memory_order_relaxed);
+		}
+		snapshot.threads = slots.size();
+		return snapshot;
+	}
+
+	// Starts a fresh measurement window; records racing the reset may land on either side of it
+	void Reset() {
+		if constexpr (!kEnabled) return;
+		std::lock_guard lock(mutex);
+		for (auto& slot : slots) {
+			std::lock_guard slotLock(slot->mutex);
+			for (auto& counters : slot->rules) {
+				for (std::size_t i = 0; i < counters.size; ++i) {
+					counters.data[i].evaluations.store(0, std::memory_order_relaxed);
+					counters.data[i].matches.store(0, std::memory_order_relaxed);
+				}
+			}
+			for (auto& histogram : slot->latency) {
+				for (auto& bucket : histogram.buckets) bucket.store(0, std::memory_order_relaxed);
+				histogram.count.store(0, std::memory_order_relaxed);
+				histogram.totalNs.store(0, std::memory_order_relaxed);
+				histogram.maxNs.store(0, std::memory_order_relaxed);
+			}
+			for (auto& cache : slot->caches) {
+				cache.hits.store(0, std::memory_order_relaxed);
+				cache.misses.store(0, std::memory_order_relaxed);
+			}
+			for (auto& event : slot->events) event.store(0, std::memory_order_relaxed);
+		}
+	}
+
+private:
+	using Counter = std::atomic<std::uint64_t>;
+
+	struct RuleCounters {
+		Counter evaluations = 0;
+		Counter matches = 0;
+	};
+
+	struct RuleArray {
+		std::unique_ptr<RuleCounters[]> data;
+		std::size_t size = 0;
+	};
+
+	struct CacheCounters {
+		Counter hits = 0;
+		Counter misses = 0;
+	};
+
+	struct Histogram {
+		std::array<Counter, LatencyBuckets::kBuckets> buckets{};
+		Counter count = 0;
+		Counter totalNs = 0;
+		Counter maxNs = 0;
+	};
+
+	// Written by its owning thread only; the mutex guards relayout against a concurrent Merge()
+	struct alignas(64) Slot {
+		std::mutex mutex;
+		std::uint64_t generation = 0;
+		std::array<RuleArray, 3> rules;
+		std::array<Histogram, kProbes> latency;
+		std::array<CacheCounters, kCaches> caches;
+		std::array<Counter, kEvents> events{};
+	};
+
+	static void Bump(Counter& counter, std::uint64_t by = 1) {
+		counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+	}
+
+	Slot& Local() {
+		thread_local Slot* local = nullptr;
+		if (!local) {
+			std::lock_guard lock(mutex);
+			local = slots.emplace_back(std::make_unique<Slot>()).get();
+		}
+		if (local->generation != generation.load(std::memory_order_acquire)) Relayout(*local);
+		return *local;
+	}
+
+	void Relayout(Slot& slot) {
+		std::lock_guard lock(mutex);
+		std::lock_guard slotLock(slot.mutex);
+		for (std::size_t k = 0; k < 3; ++k) {
+			slot.rules[k].data = std::make_unique<RuleCounters[]>(layout[k]);
+			slot.rules[k].size = layout[k];
+		}
+		slot.generation = generation.load(std::memory_order_acquire);
+	}
+
+	std::mutex mutex;  // guards slots and layout
+	std::vector<std::unique_ptr<Slot>> slots;
+	std::array<std::size_t, 3> layout{};
+	std::atomic<std::uint64_t> generation = 0;
+};
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Plugin-owned worker pool shared by all background engine work (load-time passes, price tables).
+// Every worker owns a fixed ring of task slots per priority; it pops its own newest task first and steals
+// the oldest one of another worker when it runs dry. Tasks are stored inline in their slot, so submitting
+// never allocates; when the target ring is full the task runs on the submitting thread instead.
+// Nothing here may call into the game: workers only see data captured on the main thread.
+class ThreadPool {
+public:
+	enum class Priority : std::uint8_t { High, Normal, Low };
+	static constexpr size_t kPriorities = 3;
+	static constexpr size_t kSlots = 256;        // ring capacity per worker and priority
+	static constexpr size_t kInlineBytes = 64;   // largest callable a task descriptor holds
+
+	// Counts outstanding tasks; Wait() helps running them until all finished, then rethrows the first
+	// exception a task of the group threw (the other tasks still run to completion)
+	class Group {
+	public:
+		void Wait(ThreadPool& pool) {
+			while (pending.load(std::memory_order_acquire) != 0) {
+				if (!pool.RunOne(pool.CurrentWorker())) std::this_thread::yield();
+			}
+			if (error) std::rethrow_exception(std::exchange(error, nullptr));
+		}
+
+		bool Done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class ThreadPool;
+
+		void Fail(std::exception_ptr e) {
+			std::lock_guard lock(errorMutex);
+			if (!error) error = std::move(e);
+		}
+
+		std::atomic<size_t> pending = 0;
+		std::mutex errorMutex;
+		std::exception_ptr error;  // written before the failing task's decrement, read once pending is zero
+	};
+
+	struct alignas(64) WorkerStats {
+		std::atomic<std::uint64_t> executed = 0;
+		std::atomic<std::uint64_t> stolen = 0;
+		std::atomic<std::uint64_t> busyNs = 0;
+		std::atomic<std::uint64_t> idleNs = 0;
+	};
+
+	// Threads default to two fewer than the cores, and are always kept below the core count
+	static size_t ClampThreads(size_t requested) {
+		size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+		if (!requested) requested = cores > 2 ? cores - 2 : 1;
+		return std::clamp<size_t>(requested, 1, cores - 1);
+	}
+
+	explicit ThreadPool(size_t threads = 0) : workers(ClampThreads(threads)), stats(workers.size()) {
+		for (size_t i = 0; i < workers.size(); ++i) workers[i].thread = std::thread([this, i]() { WorkerLoop(i); });
+	}
+
+	~ThreadPool() {
+		{
+			std::lock_guard lock(sleepMutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (auto& worker : workers) {
+			if (worker.thread.joinable()) worker.thread.join();
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	template <class Fn>
+	void Submit(Group& group, Priority priority, Fn&& fn) {
+		group.pending.fetch_add(1, std::memory_order_relaxed);
+
+		size_t target = CurrentWorker();
+		if (target == kNotAWorker) target = next.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+		auto& worker = workers[target];
+		{
+			std::lock_guard lock(worker.mutex);
+			auto& ring = worker.rings[static_cast<size_t>(priority)];
+			if (ring.size < kSlots) {
+				ring.slots[(ring.head + ring.size) % kSlots].Set(std::forward<Fn>(fn), &group);
+				++ring.size;
+				queued.fetch_add(1, std::memory_order_release);
+				WakeOne();
+				return;
+			}
+		}
+		// Ring full: run it here rather than allocate
+		Finish finish{ group };
+		try {
+			fn();
+		} catch (...) {
+			group.Fail(std::current_exception());
+		}
+	}
+
+	// Splits [begin, end) into chunks of `grain` and runs fn(i) for every index, waiting for all of them
+	template <class Fn>
+	void ParallelFor(size_t begin, size_t end, size_t grain, Fn&& fn, Priority priority = Priority::Normal) {
+		Group group;
+		grain = std::max<size_t>(grain, 1);
+		for (size_t lo = begin; lo < end; lo += grain) {
+			const size_t hi = std::min(end, lo + grain);
+			Submit(group, priority, [&fn, lo, hi]() {
+				for (size_t i = lo; i < hi; ++i) fn(i);
+			});
+		}
+		group.Wait(*this);
+	}
+
+	size_t Threads() const { return workers.size(); }
+	const WorkerStats& Stats(size_t worker) const { return stats[worker]; }
+
+	// Share of wall time each worker spent running tasks since the last reset, in percent
+	std::vector<double> Utilization() const {
+		std::vector<double> result;
+		for (const auto& s : stats) {
+			const double busy = static_cast<double>(s.busyNs.load(std::memory_order_relaxed));
+			const double idle = static_cast<double>(s.idleNs.load(std::memory_order_relaxed));
+			result.push_back(busy + idle > 0.0 ? 100.0 * busy / (busy + idle) : 0.0);
+		}
+		return result;
+	}
+
+	void ResetStats() {
+		for (auto& s : stats) {
+			s.executed = 0;
+			s.stolen = 0;
+			s.busyNs = 0;
+			s.idleNs = 0;
+		}
+	}
+
+private:
+	static constexpr size_t kNotAWorker = SIZE_MAX;
+	using Clock = std::chrono::steady_clock;
+
+	// Reports a task of `group` finished however it left, so Wait() cannot hang on a throwing task
+	struct Finish {
+		Group& group;
+		~Finish() { group.pending.fetch_sub(1, std::memory_order_acq_rel); }
+	};
+
+	// Type-erased callable stored in place, plus the group it reports to
+	class Task {
+	public:
+		template <class Fn>
+		void Set(Fn&& fn, Group* owner) {
+			using F = std::decay_t<Fn>;
+			static_assert(sizeof(F) <= kInlineBytes && alignof(F) <= alignof(std::max_align_t), "task callable too large for a descriptor");
+			static_assert(std::is_nothrow_move_constructible_v<F>);
+			new (storage) F(std::forward<Fn>(fn));
+			invoke = [](void* p) { (*static_cast<F*>(p))(); };
+			relocate = [](void* dst, void* src) {
+				new (dst) F(std::move(*static_cast<F*>(src)));
+				static_cast<F*>(src)->~F();
+			};
+			destroy = [](void* p) { static_cast<F*>(p)->~F(); };
+			group = owner;
+		}
+
+		void MoveTo(Task& other) {
+			relocate(other.storage, storage);
+			other.invoke = invoke;
+			other.relocate = relocate;
+			other.destroy = destroy;
+			other.group = group;
+		}
+
+		// Never throws: an exception of the callable is handed to the group
+		void Run() {
+			Finish finish{ *group };
+			try {
+				invoke(storage);
+			} catch (...) {
+				group->Fail(std::current_exception());
+			}
+			destroy(storage);
+		}
+
+	private:
+		alignas(std::max_align_t) std::byte storage[kInlineBytes];
+		void (*invoke)(void*) = nullptr;
+		void (*relocate)(void*, void*) = nullptr;
+		void (*destroy)(void*) = nullptr;
+		Group* group = nullptr;
+	};
+
+	struct Ring {
+		std::array<Task, kSlots> slots;
+		size_t head = 0;
+		size_t size = 0;
+	};
+
+	struct alignas(64) Worker {
+		std::mutex mutex;
+		std::array<Ring, kPriorities> rings;
+		std::thread thread;
+	};
+
+	struct ThreadIdentity {
+		const ThreadPool* pool = nullptr;
+		size_t index = kNotAWorker;
+	};
+
+	static ThreadIdentity& Identity() {
+		thread_local ThreadIdentity identity;
+		return identity;
+	}
+
+	size_t CurrentWorker() const {
+		const auto& identity = Identity();
+		return identity.pool == this ? identity.index : kNotAWorker;
+	}
+
+	// Owner takes its newest task, thieves the oldest
+	bool Take(size_t victim, size_t priority, bool steal, Task& out) {
+		auto& worker = workers[victim];
+		std::lock_guard lock(worker.mutex);
+		auto& ring = worker.rings[priority];
+		if (!ring.size) return false;
+		if (steal) {
+			ring.slots[ring.head].MoveTo(out);
+			ring.head = (ring.head + 1) % kSlots;
+		} else {
+			ring.slots[(ring.head + ring.size - 1) % kSlots].MoveTo(out);
+		}
+		--ring.size;
+		queued.fetch_sub(1, std::memory_order_acq_rel);
+		return true;
+	}
+
+	// Runs the most urgent task found, own ring first at every priority; false when every ring is empty
+	bool RunOne(size_t self) {
+		Task task;
+		bool found = false;
+		bool stolen = false;
+		const size_t start = self != kNotAWorker ? self + 1 : next.load(std::memory_order_relaxed);
+		for (size_t priority = 0; !found && priority < kPriorities; ++priority) {
+			found = self != kNotAWorker && Take(self, priority, false, task);
+			for (size_t n = 0; !found && n < workers.size(); ++n) {
+				const size_t victim = (start + n) % workers.size();
+				if (victim == self) continue;
+				found = stolen = Take(victim, priority, true, task);
+			}
+		}
+		if (!found) return false;
+
+		const auto begin = Clock::now();
+		task.Run();
+		if (self != kNotAWorker) {
+			auto& s = stats[self];
+			s.busyNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count(), std::memory_order_relaxed);
+			s.executed.fetch_add(1, std::memory_order_relaxed);
+			if (stolen) s.stolen.fetch_add(1, std::memory_order_relaxed);
+		}
+		return true;
+	}
+
+	void WakeOne() {
+		std::lock_guard lock(sleepMutex);
+		wake.notify_one();
+	}
+
+	void WorkerLoop(size_t self) {
+		Identity() = { this, self };
+		for (;;) {
+			if (RunOne(self)) continue;
+
+			const auto begin = Clock::now();
+			{
+				std::unique_lock lock(sleepMutex);
+				wake.wait(lock, [&]() { return stopping || queued.load(std::memory_order_acquire) != 0; });
+				if (stopping && queued.load(std::memory_order_acquire) == 0) return;
+			}
+			stats[self].idleNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count(), std::memory_order_relaxed);
+		}
+	}
+
+	std::vector<Worker> workers;
+	std::vector<WorkerStats> stats;
+	std::atomic<size_t> queued = 0;
+	std::atomic<size_t> next = 0;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	bool stopping = false;
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "telemetry.h"
+#include "../json.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Opt-in span recorder writing Chrome trace-event JSON (chrome://tracing, Perfetto).
+// Spans go into a buffer allocated once when tracing is enabled; a span is one atomic slot claim
+// and two clock reads, and spans past the capacity are counted and dropped rather than reallocating.
+// Span names and categories must be string literals; `arg` carries an entry index or a count.
+class Trace : public SINGLETON<Trace> {
+public:
+	static constexpr std::uint32_t kNoArg = UINT32_MAX;
+
+	struct Event {
+		const char* name;
+		const char* category;
+		std::uint64_t startNs;
+		std::uint64_t durationNs;
+		std::uint32_t thread;
+		std::uint32_t arg;
+	};
+
+	// Records the lifetime of the scope while tracing is enabled
+	class Span {
+	public:
+#if STOCKCONTROL_TELEMETRY
+		Span(const char* name, const char* category, std::uint32_t arg = kNoArg) {
+			auto trace = Trace::getInstance();
+			if (!trace->Enabled()) return;
+			this->trace = trace;
+			this->name = name;
+			this->category = category;
+			this->arg = arg;
+			start = trace->Now();
+		}
+		~Span() {
+			if (trace) trace->Record(name, category, start, trace->Now() - start, arg);
+		}
+
+		void SetArg(std::uint32_t value) { arg = value; }
+
+	private:
+		Trace* trace = nullptr;
+		const char* name = nullptr;
+		const char* category = nullptr;
+		std::uint64_t start = 0;
+		std::uint32_t arg = kNoArg;
+#else
+		Span(const char*, const char*, std::uint32_t = kNoArg) {}
+		void SetArg(std::uint32_t) {}
+#endif
+		Span(const Span&) = delete;
+		Span& operator=(const Span&) = delete;
+	};
+
+	// Allocates room for `capacity` spans and starts recording; 0 stops and frees the buffer.
+	// Only called while nothing is recording (config load).
+	void Enable(size_t capacity) {
+		if constexpr (!Telemetry::kEnabled) return;
+		enabled.store(false, std::memory_order_release);
+		events.reset();
+		size = 0;
+		if (!capacity) return;
+		events = std::make_unique<Event[]>(capacity);
+		size = capacity;
+		Clear();
+		enabled.store(true, std::memory_order_release);
+		logger::info("Tracing enabled, room for {} spans ({} KiB)", capacity, capacity * sizeof(Event) / 1024);
+	}
+
+	bool Enabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	std::uint64_t Now() const {
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count());
+	}
+
+	void Record(const char* name, const char* category, std::uint64_t startNs, std::uint64_t durationNs, std::uint32_t arg) {
+		const size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+		if (slot >= size) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		events[slot] = { name, category, startNs, durationNs, ThreadId(), arg };
+		written.fetch_add(1, std::memory_order_release);
+	}
+
+	// Writes every complete span as trace-event JSON, then starts a new buffer.
+	// `describe(event)` may add the args shown for a span (e.g. the config origin of an entry).
+	template <class Describe>
+	bool Write(const std::filesystem::path& path, Describe&& describe) {
+		if (!size) return false;
+		// Stop claiming slots and let spans in flight finish their store
+		const size_t claimed = std::min(next.exchange(size, std::memory_order_acq_rel), size);
+		while (written.load(std::memory_order_acquire) < claimed) std::this_thread::yield();
+
+		std::ofstream file(path);
+		if (!file.is_open()) {
+			logger::error("Failed to write trace to {}", path.string());
+			Clear();
+			return false;
+		}
+		file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+		for (size_t i = 0; i < claimed; ++i) {
+			const auto& e = events[i];
+			nlohmann::json event = { { "name", e.name }, { "cat", e.category }, { "ph", "X" }, { "pid", 1 }, { "tid", e.thread },
+				{ "ts", e.startNs / 1000.0 }, { "dur", e.durationNs / 1000.0 } };
+			nlohmann::json args = describe(e);
+			if (!args.is_null()) event["args"] = std::move(args);
+			file << (i ? ",\n" : "") << event.dump();
+		}
+		file << "\n]}\n";
+		logger::info("Wrote {} trace spans to {} ({} dropped for lack of room)", claimed, path.string(), dropped.load());
+		Clear();
+		return true;
+	}
+
+private:
+	static std::uint32_t ThreadId() {
+		static std::atomic<std::uint32_t> threads = 0;
+		thread_local const std::uint32_t id = ++threads;
+		return id;
+	}
+
+	void Clear() {
+		written.store(0, std::memory_order_relaxed);
+		dropped.store(0, std::memory_order_relaxed);
+		next.store(0, std::memory_order_release);
+	}
+
+	std::unique_ptr<Event[]> events;
+	size_t size = 0;
+	std::atomic<size_t> next = 0;
+	std::atomic<size_t> written = 0;
+	std::atomic<std::uint64_t> dropped = 0;
+	std::atomic<bool> enabled = false;
+	const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "extrahash.h"
+#include "telemetry.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+// InventoryEntryData::GetValue() per base form and value-relevant extra data (enchantment, temper, charge, soul).
+// GetValue walks the extra data lists and enchantment costs on every call; stacks with the same base form
+// and the same extras always price the same, so each one is computed once per game load (and may be
+// computed ahead of time, e.g. when the cell of a vendor loads).
+class ValueCache : public SINGLETON<ValueCache> {
+public:
+	// Base form plus the hash of its value-relevant extra data; stacks with equal keys price the same
+	struct Key {
+		RE::FormID formID;
+		std::uint64_t extra;
+
+		bool operator==(const Key&) const = default;
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const {
+			return std::hash<std::uint64_t>{}(key.extra ^ (static_cast<std::uint64_t>(key.formID) * 0x9E3779B97F4A7C15ull));
+		}
+	};
+
+	static Key KeyOf(RE::InventoryEntryData* item) {
+		return { item->object->GetFormID(), HashExtras(item) };
+	}
+
+	int Get(RE::InventoryEntryData* item) {
+		const Key key = KeyOf(item);
+		{
+			std::shared_lock lock(mutex);
+			if (auto it = values.find(key); it != values.end()) {
+				hits.fetch_add(1, std::memory_order_relaxed);
+				Telemetry::getInstance()->RecordCache(Telemetry::Cache::ItemValue, true);
+				return it->second;
+			}
+		}
+		Telemetry::getInstance()->RecordCache(Telemetry::Cache::ItemValue, false);
+		int value = item->GetValue();
+		std::unique_lock lock(mutex);
+		values.emplace(key, value);
+		return value;
+	}
+
+	// Replay: the value a recorded stack had, for the stack rebuilt from its base form
+	void Seed(RE::InventoryEntryData* item, int value) {
+		std::unique_lock lock(mutex);
+		values.insert_or_assign(KeyOf(item), value);
+	}
+
+	void Clear(const char* reason) {
+		std::unique_lock lock(mutex);
+		if (values.empty()) return;
+		logger::debug("Dropped {} cached item values ({} lookups served from cache): {}", values.size(), hits.load(), reason);
+		values.clear();
+		hits = 0;
+	}
+
+private:
+	// Hash of everything besides the base form that changes the value of the stack
+	static std::uint64_t HashExtras(RE::InventoryEntryData* item) {
+		ExtraHash hash;
+		if (!item->extraLists) return hash.Value();
+		for (auto xList : *item->extraLists) {
+			if (!xList) continue;
+			hash.List();
+			if (auto enchantment = xList->GetByType<RE::ExtraEnchantment>()) {
+				hash.Enchantment(enchantment->enchantment ? enchantment->enchantment->GetFormID() : 0, enchantment->charge);
+			}
+			if (auto health = xList->GetByType<RE::ExtraHealth>()) hash.Health(health->health);
+			if (auto charge = xList->GetByType<RE::ExtraCharge>()) hash.Charge(charge->charge);
+			if (auto soul = xList->GetByType<RE::ExtraSoul>()) hash.Soul(static_cast<std::uint8_t>(soul->GetContainedSoul()));
+		}
+		return hash.Value();
+	}
+
+	std::shared_mutex mutex;
+	std::unordered_map<Key, int, KeyHash> values;
+	std::atomic<std::uint64_t> hits = 0;
+};
@@ -0,0 +1,37 @@
+#include "BarterSession.h"
+
+#include "../../configmanager.h"
+#include "../DynamicLC/DynamicLC.h"
+
+void BarterSession::Install()
+{
+	RE::UI::GetSingleton()->AddEventSink<RE::MenuOpenCloseEvent>(GetSingleton());
+	logger::info("Listening for barter menu sessions");
+}
+
+RE::Actor* BarterSession::GetTrader()
+{
+	static REL::Relocation<RE::RefHandle*> handle{ RELOCATION_ID(519283, 405823) };
+
+	RE::TESObjectREFRPtr trader;
+	if (!*handle || !RE::TESObjectREFR::LookupByHandle(*handle, trader)) {
+		logger::warn("Barter menu opened without a trader");
+		return nullptr;
+	}
+	return trader->As<RE::Actor>();
+}
+
+RE::BSEventNotifyControl BarterSession::ProcessEvent(const RE::MenuOpenCloseEvent* a_event, RE::BSTEventSource<RE::MenuOpenCloseEvent>*)
+{
+	if (a_event && a_event->menuName == RE::BarterMenu::MENU_NAME) {
+		auto&& cfg = ConfigManager::getInstance();
+		if (a_event->opening) {
+			auto trader = GetTrader();
+			DynamicLC::FlushPending(trader);
+			cfg.BeginSession(trader);
+		}
+		else cfg.EndSession();
+	}
+
+	return RE::BSEventNotifyControl::kContinue;
+}
@@ -0,0 +1,23 @@
+class BarterSession : public RE::BSTEventSink<RE::MenuOpenCloseEvent> {
+
+public:
+    static void Install();
+protected:
+    RE::BSEventNotifyControl ProcessEvent(const RE::MenuOpenCloseEvent* a_event, RE::BSTEventSource<RE::MenuOpenCloseEvent>* a_source) override;
+
+private:
+    static RE::Actor* GetTrader();
+
+    BarterSession() = default;
+    BarterSession(const BarterSession&) = delete;
+    BarterSession(BarterSession&&) = delete;
+    ~BarterSession() override = default;
+
+    BarterSession& operator=(const BarterSession&) = delete;
+    BarterSession& operator=(BarterSession&&) = delete;
+
+    static BarterSession* GetSingleton() {
+        static BarterSession singleton;
+        return &singleton;
+    }
+};
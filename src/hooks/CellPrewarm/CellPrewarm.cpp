@@ -0,0 +1,16 @@
+#include "CellPrewarm.h"
+
+#include "../../configmanager.h"
+
+void CellPrewarm::Install()
+{
+	RE::ScriptEventSourceHolder::GetSingleton()->AddEventSink<RE::TESCellFullyLoadedEvent>(GetSingleton());
+	logger::info("Listening for cell loads to prewarm vendors");
+}
+
+RE::BSEventNotifyControl CellPrewarm::ProcessEvent(const RE::TESCellFullyLoadedEvent* a_event, RE::BSTEventSource<RE::TESCellFullyLoadedEvent>*)
+{
+	if (a_event && a_event->cell) ConfigManager::getInstance().PrewarmCell(a_event->cell);
+
+	return RE::BSEventNotifyControl::kContinue;
+}
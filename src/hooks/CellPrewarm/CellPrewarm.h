@@ -0,0 +1,22 @@
+class CellPrewarm : public RE::BSTEventSink<RE::TESCellFullyLoadedEvent> {
+
+public:
+    static void Install();
+protected:
+    RE::BSEventNotifyControl ProcessEvent(const RE::TESCellFullyLoadedEvent* a_event, RE::BSTEventSource<RE::TESCellFullyLoadedEvent>* a_source) override;
+
+private:
+
+    CellPrewarm() = default;
+    CellPrewarm(const CellPrewarm&) = delete;
+    CellPrewarm(CellPrewarm&&) = delete;
+    ~CellPrewarm() override = default;
+
+    CellPrewarm& operator=(const CellPrewarm&) = delete;
+    CellPrewarm& operator=(CellPrewarm&&) = delete;
+
+    static CellPrewarm* GetSingleton() {
+        static CellPrewarm singleton;
+        return &singleton;
+    }
+};
@@ -0,0 +1,86 @@
+#include "ConsoleCommand.h"
+
+#include "../../configmanager.h"
+
+// "StockControl" / "scs": prints engine statistics and dumps them to the SKSE log directory,
+// "scs reset" starts a new measurement window, "scs trace" writes the recorded spans as a Chrome trace,
+// "scs capture" starts or stops recording price calls and restocks, "scs replay" runs the recording again,
+// "scs export" writes the tradeable forms and vendors for offline tools.
+// Takes over the unused BetaComment command.
+void ConsoleCommand::Install()
+{
+	auto command = RE::SCRIPT_FUNCTION::LocateConsoleCommand("BetaComment");
+	if (!command) {
+		logger::warn("Console command slot not found, stats command unavailable");
+		return;
+	}
+
+	command->functionName = "StockControl";
+	command->shortName = "scs";
+	command->helpString = "Merchant stock control engine statistics: scs [stats|reset|trace|capture|replay|export]";
+	command->referenceFunction = false;
+	command->SetParameters(params);
+	command->executeFunction = Execute;
+	command->conditionFunction = nullptr;
+	logger::info("Registered console command StockControl (scs)");
+}
+
+void ConsoleCommand::Print(const std::string& line)
+{
+	if (auto console = RE::ConsoleLog::GetSingleton()) console->Print("%s", line.c_str());
+}
+
+bool ConsoleCommand::Execute(const RE::SCRIPT_PARAMETER*, RE::SCRIPT_FUNCTION::ScriptData* a_scriptData, RE::TESObjectREFR*,
+	RE::TESObjectREFR*, RE::Script*, RE::ScriptLocals*, double&, std::uint32_t&)
+{
+	std::string subcommand = "stats";
+	if (a_scriptData && a_scriptData->numParams > 0) {
+		if (auto chunk = a_scriptData->GetStringChunk()) subcommand = chunk->GetString();
+	}
+	std::ranges::transform(subcommand, subcommand.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	auto&& cfg = ConfigManager::getInstance();
+	if (subcommand == "reset") {
+		cfg.ResetStats();
+		Print("Stock control statistics reset");
+		return true;
+	}
+	if (subcommand == "trace") {
+		auto dir = SKSE::log::log_directory();
+		if (dir && cfg.WriteTrace(*dir)) Print(std::format("Trace written to StockControl_Trace.json in {}", dir->string()));
+		else Print("Tracing is off; set Engine.TraceEvents in the config to record spans");
+		return true;
+	}
+	if (subcommand == "capture" || subcommand == "replay") {
+		auto dir = SKSE::log::log_directory();
+		if (!dir) return true;
+		const auto path = *dir / "StockControl_Capture.bin";
+		if (cfg.Capturing()) {
+			Print(std::format("Capture stopped after {} records", cfg.StopCapture()));
+			if (subcommand == "capture") return true;
+		}
+		if (subcommand == "replay") {
+			for (const auto& line : cfg.ReplayCapture(path)) Print(line);
+		}
+		else if (cfg.StartCapture(path)) {
+			Print(std::format("Capturing to {}; run scs capture again to stop", path.string()));
+		}
+		return true;
+	}
+	if (subcommand == "export") {
+		auto dir = SKSE::log::log_directory();
+		if (dir && cfg.ExportForms(*dir / "StockControl_Forms.bin")) Print(std::format("Forms exported to StockControl_Forms.bin in {}", dir->string()));
+		else Print("Form export failed, see the log");
+		return true;
+	}
+	if (subcommand != "stats") {
+		Print("Usage: scs [stats|reset|trace|capture|replay|export]");
+		return true;
+	}
+
+	for (const auto& line : cfg.StatsReport(5)) Print(line);
+	if (auto dir = SKSE::log::log_directory(); dir && cfg.WriteStats(*dir)) {
+		Print(std::format("Full snapshot written to StockControl_Stats.csv/.json in {}", dir->string()));
+	}
+	return true;
+}
@@ -0,0 +1,22 @@
+class ConsoleCommand {
+
+public:
+    static void Install();
+protected:
+    static bool Execute(const RE::SCRIPT_PARAMETER* a_paramInfo, RE::SCRIPT_FUNCTION::ScriptData* a_scriptData, RE::TESObjectREFR* a_thisObj,
+        RE::TESObjectREFR* a_containingObj, RE::Script* a_scriptObj, RE::ScriptLocals* a_locals, double& a_result, std::uint32_t& a_opcodeOffsetPtr);
+
+private:
+
+    ConsoleCommand() = delete;
+    ConsoleCommand(const ConsoleCommand&) = delete;
+    ConsoleCommand(ConsoleCommand&&) = delete;
+    ~ConsoleCommand() = delete;
+
+    ConsoleCommand& operator=(const ConsoleCommand&) = delete;
+    ConsoleCommand& operator=(ConsoleCommand&&) = delete;
+
+    static void Print(const std::string& line);
+
+    inline static RE::SCRIPT_PARAMETER params[] = { { "Subcommand (stats, reset, trace, capture, replay, export)", RE::SCRIPT_PARAM_TYPE::kChar, true } };
+};
@@ -5,6 +5,52 @@
 #include <xbyak.h>
 #include <random>
 
+// Count multipliers of one InitLeveledItems of `chest`, unless they were applied already or a newer init
+// of the chest replaced that stock (the newer init brings its own)
+static void ApplyRestock(RE::TESObjectREFR* chest, RE::Actor* trader, std::uint64_t generation, const char* origin)
+{
+	auto it = DynamicLC::restocks.find(chest->GetFormID());
+	if (it == DynamicLC::restocks.end() || it->second.generation != generation || it->second.done) {
+		logger::debug("Dropped {} restock of {:08X}: superseded or already applied", origin, chest->GetFormID());
+		return;
+	}
+	it->second.done = true;
+
+	if (auto inv = chest->GetInventoryChanges()) {
+		Trace::Span span("DeferredRestock", "restock");
+		logger::info("Applying {} count multipliers to {} entries", origin, inv->entryList ? inv->entryList->size() : 0);
+		Telemetry::getInstance()->Count(Telemetry::Event::DeferredRestock);
+		ConfigManager::getInstance().ApplyCountMultipliers(trader, inv, RE::PlayerCharacter::GetSingleton());
+	}
+}
+
+// Restock of a chest other than the one being traded with, applied a frame or more later
+static FrameTask DeferredRestock(RE::ObjectRefHandle owner, RE::ActorHandle trader, std::uint64_t generation)
+{
+	auto chest = owner.get();
+	auto actor = trader.get();
+	if (!chest || !actor) co_return;  // stays pending, FlushPending applies it if the chest is traded with
+
+	ApplyRestock(chest.get(), actor.get(), generation, "deferred");
+}
+
+void DynamicLC::FlushPending(RE::Actor* trader)
+{
+	if (!trader) return;
+	auto faction = trader->GetVendorFaction();
+	for (RE::TESObjectREFR* chest : { static_cast<RE::TESObjectREFR*>(trader), faction ? faction->vendorData.merchantContainer : nullptr }) {
+		if (!chest) continue;
+		if (auto it = restocks.find(chest->GetFormID()); it != restocks.end() && !it->second.done) {
+			ApplyRestock(chest, trader, it->second.generation, "pending");
+		}
+	}
+}
+
+void DynamicLC::Reset()
+{
+	restocks.clear();
+}
+
 void DynamicLC::Install()
 {
 	REL::Relocation<std::uintptr_t> hookPoint{ RELOCATION_ID(15800, 16038), REL::VariantOffset(0xDC, 0x229, 0x0) };
@@ -15,6 +61,8 @@ void DynamicLC::Install()
 void DynamicLC::InitLeveledItems(RE::InventoryChanges* inv)
 {
 	_InitLeveledItems(inv);
+	Telemetry::Timer timer(Telemetry::Probe::InitLeveledItems);
+	Trace::Span span("InitLeveledItems", "restock");
 
 	using _GetFormEditorID = const char* (*)(std::uint32_t);
 	static auto tweaks = GetModuleHandle(L"po3_Tweaks");
@@ -30,9 +78,23 @@ void DynamicLC::InitLeveledItems(RE::InventoryChanges* inv)
 			auto&& cfg = ConfigManager::getInstance();
 			RE::TESObjectREFRPtr trader;
 			if (RE::TESObjectREFR::LookupByHandle(*handle, trader)) {
-				for (auto&& item : *inv->entryList) {
-					logger::info("Applying count multiplier to {}", item->GetDisplayName());
-					item->countDelta *= cfg.GetCountMultiplier(trader->As<RE::Actor>(), item, RE::PlayerCharacter::GetSingleton());
+				auto actor = trader->As<RE::Actor>();
+				auto faction = actor ? actor->GetVendorFaction() : nullptr;
+
+				// A new init replaces the stock, so a restock still queued for the chest no longer applies
+				auto& restock = restocks[inv->owner->GetFormID()];
+				restock = { ++generation, false };
+
+				// Only the stock about to be shown has to be ready now
+				if (inv->owner == actor || (faction && inv->owner == faction->vendorData.merchantContainer)) {
+					logger::info("Applying count multipliers to {} entries", inv->entryList->size());
+					Telemetry::getInstance()->Count(Telemetry::Event::Restock);
+					restock.done = true;
+					cfg.ApplyCountMultipliers(actor, inv, RE::PlayerCharacter::GetSingleton());
+				}
+				else if (actor) {
+					Scheduler::getInstance()->Spawn(std::format("restock {:08X}", inv->owner->GetFormID()),
+						DeferredRestock(inv->owner->GetHandle(), actor->GetHandle(), restock.generation));
 				}
 			}
 			else {
@@ -52,16 +114,18 @@ void DynamicLC::InitLeveledItems(RE::InventoryChanges* inv)
 // RE::GFxValue& a_updateObj is the item's gfx object
 // bool is_buying is whether the player is buying item from merchant (true) or selling to the merchant (false)
 extern "C" __declspec(dllexport) float MerchantPriceCallback(RE::Actor* trader, RE::InventoryEntryData* objDesc, uint16_t a_level, RE::GFxValue& a_updateObj, bool is_buying) {
+	auto&& cfg = ConfigManager::getInstance();
+	auto player = RE::PlayerCharacter::GetSingleton();
+	float multiplier = 1.0f;
 	if (is_buying) {
-		auto&& cfg = ConfigManager::getInstance();
 		logger::info("Applying buy price multiplier to {}", objDesc->GetDisplayName());
-		return cfg.GetBuyPriceMultiplier(trader, objDesc, RE::PlayerCharacter::GetSingleton());
+		multiplier = cfg.GetBuyPriceMultiplier(trader, objDesc, player);
 	}
 	else {
-		auto&& cfg = ConfigManager::getInstance();
 		logger::info("Applying sell price multiplier to {}", objDesc->GetDisplayName());
-		return cfg.GetSellPriceMultiplier(trader, objDesc, RE::PlayerCharacter::GetSingleton());
+		multiplier = cfg.GetSellPriceMultiplier(trader, objDesc, player);
 	}
+	if (cfg.Capturing()) cfg.CapturePrice(trader, objDesc, player, is_buying, multiplier);
 	
-	return 1.0f;
+	return multiplier;
 }
@@ -2,6 +2,19 @@ class DynamicLC {
 
 public:
     static void Install();
+
+    // Applies a restock still pending for the trader or its merchant chest, before the stock is shown
+    static void FlushPending(RE::Actor* trader);
+    // Forgets every pending restock, their chests belong to the previous game
+    static void Reset();
+
+    // Latest InitLeveledItems per chest reference; main thread only
+    struct Restock {
+        std::uint64_t generation = 0;  // a newer init of the chest replaces the stock of an older one
+        bool done = false;             // count multipliers applied to this stock
+    };
+    inline static std::unordered_map<RE::FormID, Restock> restocks;
+    inline static std::uint64_t generation = 0;
 protected:
     static void InitLeveledItems(RE::InventoryChanges* inv);
 
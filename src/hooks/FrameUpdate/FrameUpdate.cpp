@@ -0,0 +1,18 @@
+#include "FrameUpdate.h"
+
+#include "../../engine/scheduler.h"
+
+void FrameUpdate::Install()
+{
+	REL::Relocation<std::uintptr_t> hookPoint{ RELOCATION_ID(35565, 36564), REL::VariantOffset(0x748, 0xC26, 0x7EE) };
+
+	_Update = SKSE::GetTrampoline().write_call<5>(hookPoint.address(), Update);
+}
+
+// Main::Update, once per frame on the main thread
+void FrameUpdate::Update(RE::Main* a_this, float a_delta)
+{
+	_Update(a_this, a_delta);
+
+	Scheduler::getInstance()->RunFrame();
+}
@@ -0,0 +1,19 @@
+class FrameUpdate {
+
+public:
+    static void Install();
+protected:
+    static void Update(RE::Main* a_this, float a_delta);
+
+private:
+
+    FrameUpdate() = delete;
+    FrameUpdate(const FrameUpdate&) = delete;
+    FrameUpdate(FrameUpdate&&) = delete;
+    ~FrameUpdate() = delete;
+
+    FrameUpdate& operator=(const FrameUpdate&) = delete;
+    FrameUpdate& operator=(FrameUpdate&&) = delete;
+
+    inline static REL::Relocation<decltype(Update)> _Update;
+};
@@ -0,0 +1,17 @@
+#include "RelationshipEvents.h"
+
+#include "../../engine/relationshipcache.h"
+
+void RelationshipEvents::Install()
+{
+	RE::ScriptEventSourceHolder::GetSingleton()->AddEventSink<RE::TESQuestStageEvent>(GetSingleton());
+	logger::info("Listening for quest stage changes to refresh relationship ranks");
+}
+
+// Relationship ranks are set by quest and dialogue scripts, which run alongside stage changes
+RE::BSEventNotifyControl RelationshipEvents::ProcessEvent(const RE::TESQuestStageEvent* a_event, RE::BSTEventSource<RE::TESQuestStageEvent>*)
+{
+	if (a_event) RelationshipCache::getInstance()->Invalidate("quest stage changed");
+
+	return RE::BSEventNotifyControl::kContinue;
+}
@@ -0,0 +1,22 @@
+class RelationshipEvents : public RE::BSTEventSink<RE::TESQuestStageEvent> {
+
+public:
+    static void Install();
+protected:
+    RE::BSEventNotifyControl ProcessEvent(const RE::TESQuestStageEvent* a_event, RE::BSTEventSource<RE::TESQuestStageEvent>* a_source) override;
+
+private:
+
+    RelationshipEvents() = default;
+    RelationshipEvents(const RelationshipEvents&) = delete;
+    RelationshipEvents(RelationshipEvents&&) = delete;
+    ~RelationshipEvents() override = default;
+
+    RelationshipEvents& operator=(const RelationshipEvents&) = delete;
+    RelationshipEvents& operator=(RelationshipEvents&&) = delete;
+
+    static RelationshipEvents* GetSingleton() {
+        static RelationshipEvents singleton;
+        return &singleton;
+    }
+};
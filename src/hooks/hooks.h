@@ -1,12 +1,18 @@
 #include <MinHook.h>
 
 #include "DynamicLC/DynamicLC.h"
+#include "FrameUpdate/FrameUpdate.h"
+#include "BarterSession/BarterSession.h"
+#include "RelationshipEvents/RelationshipEvents.h"
+#include "CellPrewarm/CellPrewarm.h"
+#include "ConsoleCommand/ConsoleCommand.h"
 
 namespace Hooks {
     void Install() { 
         MH_Initialize();
 
         DynamicLC::Install();
+        FrameUpdate::Install();
 
         MH_EnableHook(MH_ALL_HOOKS);
         return;
@@ -14,6 +20,11 @@ namespace Hooks {
 
     void InstallLate() {
 
+        BarterSession::Install();
+        RelationshipEvents::Install();
+        CellPrewarm::Install();
+        ConsoleCommand::Install();
+
         MH_EnableHook(MH_ALL_HOOKS);
     }
 }
\ No newline at end of file
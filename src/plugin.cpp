@@ -1,6 +1,7 @@
 #include <spdlog/sinks/basic_file_sink.h>
 
 #include "hooks/hooks.h"
+#include "configmanager.h"
 
 void InitializeLog() {
     auto logsFolder = SKSE::log::log_directory();
@@ -29,11 +30,29 @@ SKSEPluginLoad(const SKSE::LoadInterface *skse) {
             Hooks::InstallLate();
 
         }
+        else if (message->type == SKSE::MessagingInterface::kNewGame) {
+
+            // Config, keyword masks and item classes are built on first use: keyword distributors (KID, SPID)
+            // add keywords during kDataLoaded in no fixed order relative to this plugin, and are done by now
+            ConfigManager::getInstance();
+        }
         else if (message->type == SKSE::MessagingInterface::kPostLoad) {
             
         }
         else if (message->type == SKSE::MessagingInterface::kPostLoadGame) {
             
+            RelationshipCache::getInstance()->Invalidate("game loaded");
+            ValueCache::getInstance()->Clear("game loaded");
+            DynamicLC::Reset();
+            RelationshipCache::getInstance()->Prewarm(RE::PlayerCharacter::GetSingleton()->GetParentCell());
+
+            auto&& cfg = ConfigManager::getInstance();  // first use builds the keyword masks, see kNewGame
+            cfg.Reoptimize();
+            if (cfg.Settings().benchmark) cfg.RunBenchmark();
+        }
+        else if (message->type == SKSE::MessagingInterface::kSaveGame) {
+
+            ConfigManager::getInstance().FlushPredicateStats();
         }
         });
 
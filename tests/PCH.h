@@ -0,0 +1,15 @@
+#pragma once
+
+// Stand-in for .buildenv/PCH.h without the game: logging compiles to nothing
+
+#include <string>
+#include <utility>
+
+namespace logger {
+	template <class... Args> void trace(Args&&...) {}
+	template <class... Args> void debug(Args&&...) {}
+	template <class... Args> void info(Args&&...) {}
+	template <class... Args> void warn(Args&&...) {}
+	template <class... Args> void error(Args&&...) {}
+	template <class... Args> void critical(Args&&...) {}
+}
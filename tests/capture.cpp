@@ -0,0 +1,174 @@
+#include "capture.h"
+
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+	const std::vector<Capture::Roll> kRestockRolls = { { 0, 1, 1.5f }, { 1, 1, 0.75f } };
+
+	std::filesystem::path TempPath(const char* name) {
+		return std::filesystem::temp_directory_path() / name;
+	}
+
+	std::vector<char> ReadAll(const std::filesystem::path& path) {
+		std::ifstream in(path, std::ios::binary);
+		return { std::istreambuf_iterator<char>(in), {} };
+	}
+
+	void WriteAll(const std::filesystem::path& path, const std::vector<char>& bytes) {
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	}
+
+	Capture::State SampleState() {
+		Capture::State state;
+		state.trader = 0x0001A67C;
+		state.traderBase = 0x0001A67B;
+		state.relationship = 2.0f;
+		state.level = 31.0f;
+		state.skills = { { 14, 55.0f }, { 17, 20.0f } };
+		state.perks = { { 0x000BE128, 1 } };
+		state.globals = { { 0x00000039, 7.0f } };
+		return state;
+	}
+
+	// Writes one price and one restock record, returns the file's bytes
+	std::vector<char> SampleFile(const std::filesystem::path& path) {
+		Capture::Writer writer;
+		REQUIRE(writer.Open(path));
+		writer.Write(Capture::Price{ SampleState(), { 0x00012EB7, 1, 25, 9.0f, 0 }, true, 1.25f, { { 0, 3, 1.1f } } });
+		writer.Write(Capture::Restock{ SampleState(), 0x000A6BD4, { { 0x0003EADE, 10, 2, 1.0f, 15 }, { 0x00034CDD, 3, 4, 0.5f, 4 } }, kRestockRolls });
+		writer.Close();
+		return ReadAll(path);
+	}
+
+	struct Decoded {
+		std::vector<Capture::Price> prices;
+		std::vector<Capture::Restock> restocks;
+		bool complete = false;
+	};
+
+	Decoded Decode(const std::filesystem::path& path) {
+		Decoded decoded;
+		auto file = Capture::File::Load(path);
+		REQUIRE(file);
+		decoded.complete = file->ForEach([&](const Capture::Price& price) { decoded.prices.push_back(price); },
+			[&](const Capture::Restock& restock) { decoded.restocks.push_back(restock); });
+		return decoded;
+	}
+
+	// Offset of the u32 item count of the restock record written by SampleFile
+	size_t RestockCountOffset(const std::vector<char>& bytes) {
+		size_t at = 16;
+		std::uint32_t size = 0;
+		std::memcpy(&size, bytes.data() + at + 4, sizeof(size));
+		at += 8 + size;  // past the price record
+		std::uint32_t restockSize = 0;
+		std::memcpy(&restockSize, bytes.data() + at + 4, sizeof(restockSize));
+		const size_t rollBytes = sizeof(std::uint32_t) + kRestockRolls.size() * Capture::kRollBytes;
+		return at + 8 + restockSize - rollBytes - 2 * Capture::kItemBytes - sizeof(std::uint32_t);
+	}
+}
+
+TEST_CASE("A capture reads back what was written", "[capture]") {
+	const auto path = TempPath("capture_roundtrip.bin");
+	SampleFile(path);
+	const auto decoded = Decode(path);
+	CHECK(decoded.complete);
+	REQUIRE(decoded.prices.size() == 1);
+	REQUIRE(decoded.restocks.size() == 1);
+
+	const auto& price = decoded.prices[0];
+	CHECK(price.buying);
+	CHECK(price.multiplier == 1.25f);
+	CHECK(price.item.form == 0x00012EB7);
+	CHECK(price.state.skills == SampleState().skills);
+	CHECK(price.state.perks == SampleState().perks);
+	CHECK(price.state.globals == SampleState().globals);
+	REQUIRE(price.rolls.size() == 1);
+	CHECK(price.rolls[0].entry == 3);
+	CHECK(price.rolls[0].value == 1.1f);
+
+	const auto& restock = decoded.restocks[0];
+	CHECK(restock.owner == 0x000A6BD4);
+	REQUIRE(restock.items.size() == 2);
+	CHECK(restock.items[0].result == 15);
+	CHECK(restock.items[1].weight == 0.5f);
+	REQUIRE(restock.rolls.size() == kRestockRolls.size());
+	for (size_t n = 0; n < kRestockRolls.size(); ++n) {
+		CHECK(restock.rolls[n].item == kRestockRolls[n].item);
+		CHECK(restock.rolls[n].entry == kRestockRolls[n].entry);
+		CHECK(restock.rolls[n].value == kRestockRolls[n].value);
+	}
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("A truncated capture stops after the last whole record", "[capture]") {
+	const auto path = TempPath("capture_truncated.bin");
+	auto bytes = SampleFile(path);
+	for (size_t cut : { size_t{ 3 }, size_t{ 10 }, size_t{ 41 } }) {
+		WriteAll(path, { bytes.begin(), bytes.end() - static_cast<std::ptrdiff_t>(cut) });
+		const auto decoded = Decode(path);
+		CHECK_FALSE(decoded.complete);
+		CHECK(decoded.prices.size() == 1);
+		CHECK(decoded.restocks.empty());
+	}
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Corrupt counts are rejected before anything is sized by them", "[capture]") {
+	const auto path = TempPath("capture_corrupt.bin");
+	auto bytes = SampleFile(path);
+
+	SECTION("record size past the end of the file") {
+		const std::uint32_t huge = 0xFFFFFFF0u;
+		std::memcpy(bytes.data() + 16 + 4, &huge, sizeof(huge));
+		WriteAll(path, bytes);
+		const auto decoded = Decode(path);
+		CHECK_FALSE(decoded.complete);
+		CHECK(decoded.prices.empty());
+	}
+	SECTION("restock item count larger than its payload") {
+		const std::uint32_t huge = 0x7FFFFFFFu;
+		std::memcpy(bytes.data() + RestockCountOffset(bytes), &huge, sizeof(huge));
+		WriteAll(path, bytes);
+		const auto decoded = Decode(path);
+		CHECK_FALSE(decoded.complete);
+		CHECK(decoded.prices.size() == 1);
+		CHECK(decoded.restocks.empty());
+	}
+	SECTION("roll count larger than its payload") {
+		const std::uint32_t huge = 0x10000000u;
+		std::memcpy(bytes.data() + bytes.size() - sizeof(std::uint32_t) - kRestockRolls.size() * Capture::kRollBytes, &huge, sizeof(huge));
+		WriteAll(path, bytes);
+		const auto decoded = Decode(path);
+		CHECK_FALSE(decoded.complete);
+		CHECK(decoded.prices.size() == 1);
+		CHECK(decoded.restocks.empty());
+	}
+	SECTION("pair count larger than its payload") {
+		// The skill count follows trader, base, relationship and level in the price record's state
+		const std::uint16_t huge = 0xFFFF;
+		std::memcpy(bytes.data() + 16 + 8 + 16, &huge, sizeof(huge));
+		WriteAll(path, bytes);
+		const auto decoded = Decode(path);
+		CHECK_FALSE(decoded.complete);
+		CHECK(decoded.prices.empty());
+	}
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Foreign files and other versions do not load", "[capture]") {
+	const auto path = TempPath("capture_foreign.bin");
+	auto bytes = SampleFile(path);
+	bytes[8] = 9;  // version
+	WriteAll(path, bytes);
+	CHECK_FALSE(Capture::File::Load(path));
+	WriteAll(path, { 'n', 'o', 't' });
+	CHECK_FALSE(Capture::File::Load(path));
+	std::filesystem::remove(path);
+	CHECK_FALSE(Capture::File::Load(path));
+}
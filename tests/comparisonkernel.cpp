@@ -0,0 +1,94 @@
+#include "comparisonfilter.h"
+#include "comparisonkernel.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+	constexpr float kInf = std::numeric_limits<float>::infinity();
+	constexpr float kNaN = std::numeric_limits<float>::quiet_NaN();
+
+	ComparisonFilter Filter(ComparisonFilter::ComparisonType type, float value) {
+		ComparisonFilter filter;
+		filter.type = type;
+		filter.value = value;
+		return filter;
+	}
+
+	std::vector<ComparisonKernel::ISA> Paths() {
+		std::vector<ComparisonKernel::ISA> paths{ ComparisonKernel::ISA::Scalar, ComparisonKernel::ISA::SSE };
+		if (ComparisonKernel::DetectISA() == ComparisonKernel::ISA::AVX2) paths.push_back(ComparisonKernel::ISA::AVX2);
+		return paths;
+	}
+}
+
+// Every kernel path must agree with ComparisonFilter::Matches, the evaluation the kernel replaced
+TEST_CASE("Comparison kernel matches ComparisonFilter on every path", "[comparisonkernel]") {
+	const float thresholds[] = { -kInf, -1.0f, -0.0f, 0.0f, 0.5f, 1.0f, 1e9f, kInf, kNaN };
+	std::vector<ComparisonFilter> filters;
+	for (int type = ComparisonFilter::NONE; type <= ComparisonFilter::LESS_EQUAL; ++type) {
+		for (float t : thresholds) filters.push_back(Filter(static_cast<ComparisonFilter::ComparisonType>(type), t));
+	}
+
+	// Every weight filter with every value filter, including equal bounds on both columns
+	ComparisonKernel kernel;
+	std::vector<std::pair<const ComparisonFilter*, const ComparisonFilter*>> rows;
+	for (const auto& weight : filters) {
+		for (const auto& value : filters) {
+			kernel.AddRow(weight.AcceptMask(), weight.value, value.AcceptMask(), value.value);
+			rows.emplace_back(&weight, &value);
+		}
+	}
+
+	std::vector<float> probes{ kNaN, -kNaN, 0.0f, -0.0f };
+	for (float t : thresholds) {
+		probes.push_back(t);
+		probes.push_back(std::nextafter(t, -kInf));
+		probes.push_back(std::nextafter(t, kInf));
+	}
+
+	RuleMask out;
+	for (auto isa : Paths()) {
+		size_t mismatches = 0;
+		for (float w : probes) {
+			for (float v : probes) {
+				kernel.Evaluate(w, v, out, isa);
+				REQUIRE(out.Size() == rows.size());
+				for (size_t i = 0; i < rows.size(); ++i) {
+					const bool expected = rows[i].first->Matches(w) && rows[i].second->Matches(v);
+					if (out.Test(i) != expected) {
+						++mismatches;
+						UNSCOPED_INFO("isa " << static_cast<int>(isa) << " row " << i << " weight " << w << " value " << v);
+					}
+				}
+			}
+		}
+		CHECK(mismatches == 0);
+	}
+}
+
+TEST_CASE("NONE accepts NaN items, every operator rejects them", "[comparisonkernel]") {
+	ComparisonKernel kernel;
+	kernel.AddRow(ComparisonKernel::kAny, 0.0f, ComparisonKernel::kAny, 0.0f);
+	kernel.AddRow(ComparisonKernel::kGreater | ComparisonKernel::kEqual, 0.0f, ComparisonKernel::kAny, 0.0f);
+	kernel.AddRow(ComparisonKernel::kLess | ComparisonKernel::kEqual, 0.0f, ComparisonKernel::kAny, 0.0f);
+
+	RuleMask out;
+	for (auto isa : Paths()) {
+		kernel.Evaluate(kNaN, kNaN, out, isa);
+		CHECK(out.Test(0));
+		CHECK_FALSE(out.Test(1));
+		CHECK_FALSE(out.Test(2));
+	}
+}
+
+TEST_CASE("Only rows filtering on value need the value column", "[comparisonkernel]") {
+	ComparisonKernel kernel;
+	kernel.AddRow(ComparisonKernel::kLess, 5.0f, ComparisonKernel::kAny, 0.0f);
+	CHECK_FALSE(kernel.HasValueColumn());
+	kernel.AddRow(ComparisonKernel::kAny, 0.0f, ComparisonKernel::kGreater, 100.0f);
+	CHECK(kernel.HasValueColumn());
+}
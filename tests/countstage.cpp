@@ -0,0 +1,149 @@
+#include "countstage.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+	using Rounding = CountStage::Rounding;
+	constexpr Rounding kModes[] = { Rounding::Truncate, Rounding::Floor, Rounding::Ceil, Rounding::Nearest };
+
+	struct Lane {
+		std::int32_t count;
+		float multiplier;
+		std::int32_t low = CountStage::kNoCap;
+		std::int32_t high = CountStage::kNoCap;
+		Rounding rounding = Rounding::Truncate;
+	};
+
+	// Runs lanes through the stage, padded past kVectorThreshold so the SSE path handles them
+	std::vector<std::int32_t> RunStage(const std::vector<Lane>& lanes) {
+		CountStage stage;
+		for (const auto& lane : lanes) stage.Push(lane.count, lane.multiplier, lane.low, lane.high, lane.rounding);
+		while (stage.Size() < CountStage::kVectorThreshold || stage.Size() % 4) stage.Push(1, 1.0f, CountStage::kNoCap, CountStage::kNoCap, Rounding::Truncate);
+		stage.Run();
+		std::vector<std::int32_t> results;
+		for (size_t i = 0; i < lanes.size(); ++i) results.push_back(stage.Result(i));
+		return results;
+	}
+
+	// The reference, with caps converted as Push() does
+	std::int32_t Scalar(const Lane& lane) {
+		const std::int32_t low = lane.low == CountStage::kNoCap ? INT32_MIN : lane.low;
+		const std::int32_t high = lane.high == CountStage::kNoCap ? INT32_MAX : lane.high;
+		return CountStage::Scalar(lane.count, lane.multiplier, low, high, lane.rounding);
+	}
+}
+
+TEST_CASE("Rounding modes", "[countstage]") {
+	CHECK(Scalar({ 10, 0.25f, 0, 0, Rounding::Truncate }) == 2);
+	CHECK(Scalar({ 10, 0.25f, 0, 0, Rounding::Floor }) == 2);
+	CHECK(Scalar({ 10, 0.25f, 0, 0, Rounding::Ceil }) == 3);
+	CHECK(Scalar({ 10, 0.25f, 0, 0, Rounding::Nearest }) == 3);  // 2.5, halves away from zero
+	CHECK(Scalar({ 10, 0.24f, 0, 0, Rounding::Nearest }) == 2);
+	CHECK(Scalar({ 3, -0.5f, 0, 0, Rounding::Nearest }) == -2);  // -1.5
+	CHECK(Scalar({ 3, -0.5f, 0, 0, Rounding::Floor }) == -2);
+	CHECK(Scalar({ 3, -0.5f, 0, 0, Rounding::Ceil }) == -1);
+}
+
+TEST_CASE("Nearest rounds just below a half down on both paths", "[countstage]") {
+	const float belowHalf = std::nextafter(0.5f, 0.0f);  // 0.49999997f: adding 0.5f would round up to 1
+	const std::vector<Lane> lanes{ { 1, belowHalf, 0, 0, Rounding::Nearest }, { 1, 0.5f, 0, 0, Rounding::Nearest },
+		{ 1, std::nextafter(1.5f, 0.0f), 0, 0, Rounding::Nearest } };
+	CHECK(Scalar(lanes[0]) == 0);
+	CHECK(Scalar(lanes[1]) == 1);
+	CHECK(Scalar(lanes[2]) == 1);
+	CHECK(RunStage(lanes) == std::vector<std::int32_t>{ 0, 1, 1 });
+}
+
+TEST_CASE("Caps apply after rounding and never to removals", "[countstage]") {
+	const std::vector<Lane> lanes{
+		{ 10, 3.0f, 0, 20, Rounding::Truncate },  // capped high
+		{ 10, 0.1f, 5, 0, Rounding::Truncate },   // raised to the low cap
+		{ 0, 5.0f, 5, 0, Rounding::Truncate },    // nothing restocked, low cap ignored
+		{ -4, 5.0f, 5, 20, Rounding::Truncate },  // removal scaled, caps ignored
+	};
+	const std::vector<std::int32_t> expected{ 20, 5, 0, -20 };
+	for (size_t i = 0; i < lanes.size(); ++i) CHECK(Scalar(lanes[i]) == expected[i]);
+	CHECK(RunStage(lanes) == expected);
+}
+
+// The multiplier and rounding mode apply to removals as they always have; only the caps skip them
+TEST_CASE("Removals are scaled and rounded", "[countstage]") {
+	const std::vector<Lane> lanes{
+		{ -3, 0.5f, 0, 0, Rounding::Truncate },  // -1.5
+		{ -3, 0.5f, 0, 0, Rounding::Floor },
+		{ -3, 0.5f, 0, 0, Rounding::Ceil },
+		{ -3, 0.5f, 0, 0, Rounding::Nearest },
+		{ -3, 0.5f, 1, 5, Rounding::Floor },     // low cap would turn it into stock
+		{ -10, 3.0f, 0, 20, Rounding::Truncate },
+		{ -2, -1.5f, 0, 2, Rounding::Truncate }, // negative multiplier, high cap ignored
+	};
+	const std::vector<std::int32_t> expected{ -1, -2, -1, -2, -2, -30, 3 };
+	for (size_t i = 0; i < lanes.size(); ++i) CHECK(Scalar(lanes[i]) == expected[i]);
+	CHECK(RunStage(lanes) == expected);
+}
+
+TEST_CASE("NaN and infinite multipliers", "[countstage]") {
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	const float inf = std::numeric_limits<float>::infinity();
+	std::vector<Lane> lanes;
+	for (auto mode : kModes) {
+		lanes.push_back({ 7, nan, 0, 0, mode });
+		lanes.push_back({ 7, nan, 1, 3, mode });
+		lanes.push_back({ 7, inf, 0, 100, mode });
+		lanes.push_back({ 7, -inf, -100, 0, mode });
+	}
+	const auto vector = RunStage(lanes);
+	for (size_t i = 0; i < lanes.size(); ++i) {
+		INFO("lane " << i);
+		CHECK(vector[i] == Scalar(lanes[i]));
+	}
+	CHECK(Scalar(lanes[0]) == 7);  // NaN leaves the count alone
+	CHECK(Scalar(lanes[1]) == 7);
+	CHECK(Scalar(lanes[2]) == 100);
+	CHECK(Scalar(lanes[3]) == -100);
+}
+
+// Randomized lanes, focused on values at and around the rounding boundaries
+TEST_CASE("SSE path matches the scalar reference", "[countstage]") {
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<std::int32_t> counts(-5, 1000);
+	std::uniform_int_distribution<std::int32_t> halves(-400, 400);
+	std::uniform_int_distribution<int> modes(0, 3);
+	std::uniform_int_distribution<std::int32_t> caps(0, 300);
+	std::uniform_int_distribution<int> nudge(-2, 2);
+
+	std::vector<Lane> lanes;
+	for (int n = 0; n < 20000; ++n) {
+		Lane lane{ counts(rng), 0.0f };
+		// multipliers landing on or a few ulps off x.5 and whole numbers
+		float target = halves(rng) * 0.5f;
+		for (int k = nudge(rng); k; k += k > 0 ? -1 : 1) target = std::nextafter(target, k > 0 ? INFINITY : -INFINITY);
+		lane.multiplier = lane.count ? target / static_cast<float>(lane.count) : target;
+		lane.low = caps(rng) % 4 ? CountStage::kNoCap : caps(rng);
+		lane.high = caps(rng) % 4 ? CountStage::kNoCap : caps(rng) + 300;
+		lane.rounding = kModes[modes(rng)];
+		lanes.push_back(lane);
+	}
+
+	const auto vector = RunStage(lanes);
+	size_t mismatches = 0;
+	for (size_t i = 0; i < lanes.size(); ++i) {
+		if (vector[i] == Scalar(lanes[i])) continue;
+		++mismatches;
+		UNSCOPED_INFO("lane " << i << ": " << lanes[i].count << " x " << lanes[i].multiplier << " -> " << vector[i] << " vs " << Scalar(lanes[i]));
+	}
+	CHECK(mismatches == 0);
+}
+
+TEST_CASE("Rounding modes parse by name", "[countstage]") {
+	CHECK(CountStage::ParseRounding("floor") == Rounding::Floor);
+	CHECK(CountStage::ParseRounding("ceil") == Rounding::Ceil);
+	CHECK(CountStage::ParseRounding("nearest") == Rounding::Nearest);
+	CHECK(CountStage::ParseRounding("truncate") == Rounding::Truncate);
+	CHECK(CountStage::ParseRounding("round") == Rounding::Truncate);  // unknown: warns, truncates
+}
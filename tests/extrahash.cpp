@@ -0,0 +1,60 @@
+#include "extrahash.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace {
+	// One extra data list of a stack, with the fields ValueCache hashes
+	struct List {
+		std::optional<std::pair<std::uint32_t, std::uint16_t>> enchantment{};
+		std::optional<float> health{};
+		std::optional<float> charge{};
+		std::optional<std::uint8_t> soul{};
+	};
+
+	// Walks the lists the way ValueCache::HashExtras does
+	std::uint64_t KeyOf(const std::vector<List>& lists) {
+		ExtraHash hash;
+		for (const auto& list : lists) {
+			hash.List();
+			if (list.enchantment) hash.Enchantment(list.enchantment->first, list.enchantment->second);
+			if (list.health) hash.Health(*list.health);
+			if (list.charge) hash.Charge(*list.charge);
+			if (list.soul) hash.Soul(*list.soul);
+		}
+		return hash.Value();
+	}
+}
+
+TEST_CASE("Stacks with the same extras share a key", "[extrahash]") {
+	const List list{ .enchantment = std::pair{ 0x000B2E3Cu, std::uint16_t{ 500 } }, .health = 1.2f, .soul = 3 };
+	CHECK(KeyOf({ list }) == KeyOf({ list }));
+	CHECK(KeyOf({}) == KeyOf({}));
+}
+
+TEST_CASE("Stacks differing only in soul level get different keys", "[extrahash]") {
+	// Empty, petty, lesser, common, greater, grand
+	std::vector<std::uint64_t> keys;
+	for (std::uint8_t level = 0; level <= 5; ++level) keys.push_back(KeyOf({ List{ .soul = level } }));
+	for (size_t i = 0; i < keys.size(); ++i) {
+		for (size_t j = i + 1; j < keys.size(); ++j) CHECK(keys[i] != keys[j]);
+	}
+	CHECK(KeyOf({ List{ .soul = 0 } }) != KeyOf({ List{} }));
+}
+
+TEST_CASE("Stacks differing only in charge or temper get different keys", "[extrahash]") {
+	CHECK(KeyOf({ List{ .charge = 100.0f } }) != KeyOf({ List{ .charge = 250.0f } }));
+	CHECK(KeyOf({ List{ .health = 1.1f } }) != KeyOf({ List{ .health = 1.6f } }));
+	CHECK(KeyOf({ List{ .enchantment = std::pair{ 1u, std::uint16_t{ 10 } } } }) != KeyOf({ List{ .enchantment = std::pair{ 1u, std::uint16_t{ 20 } } } }));
+	CHECK(KeyOf({ List{ .enchantment = std::pair{ 1u, std::uint16_t{ 10 } } } }) != KeyOf({ List{ .enchantment = std::pair{ 2u, std::uint16_t{ 10 } } } }));
+}
+
+TEST_CASE("The same value in different fields gets different keys", "[extrahash]") {
+	CHECK(KeyOf({ List{ .health = 2.0f } }) != KeyOf({ List{ .charge = 2.0f } }));
+	CHECK(KeyOf({ List{ .soul = 2 } }) != KeyOf({ List{ .enchantment = std::pair{ 2u, std::uint16_t{ 0 } } } }));
+	// A field in the first list is not the same stack as that field in the second
+	CHECK(KeyOf({ List{ .soul = 2 }, List{} }) != KeyOf({ List{}, List{ .soul = 2 } }));
+}
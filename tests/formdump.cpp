@@ -0,0 +1,165 @@
+#include "formdump.h"
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+	std::filesystem::path TempPath(const char* name) {
+		return std::filesystem::temp_directory_path() / name;
+	}
+
+	// The file's bytes in 8-byte aligned storage, as a mapping would give them
+	struct Bytes {
+		std::vector<std::uint64_t> words;
+		size_t size = 0;
+
+		char* data() { return reinterpret_cast<char*>(words.data()); }
+		FormDump::View Map() const { return { words.data(), size }; }
+		FormDump::Header& Header() { return *reinterpret_cast<FormDump::Header*>(data()); }
+	};
+
+	Bytes ReadAll(const std::filesystem::path& path) {
+		Bytes bytes;
+		bytes.size = static_cast<size_t>(std::filesystem::file_size(path));
+		bytes.words.resize((bytes.size + 7) / 8);
+		std::ifstream in(path, std::ios::binary);
+		in.read(bytes.data(), static_cast<std::streamsize>(bytes.size));
+		return bytes;
+	}
+
+	constexpr std::array<std::uint32_t, 3> kIronKeywords = { 0x0001E711, 0x0008F958, 0x000914E6 };
+	constexpr std::array<std::uint32_t, 2> kBelethorFactions = { 0x0005A1A4, 0x000E0CD9 };
+	constexpr std::array<std::uint32_t, 1> kBelethorChests = { 0x000A6BD4 };
+
+	// Adds records out of FormID order, so Write has to sort them; returns the file's bytes
+	Bytes SampleFile(const std::filesystem::path& path) {
+		FormDump::Builder builder;
+		builder.Add(FormDump::Form{ 0x00012EB7, builder.String("IronDagger"), builder.Ids(kIronKeywords), 2.0f, 10, 41 });
+		builder.Add(FormDump::Form{ 0x0003EADE, builder.String(""), {}, 1.0f, 150, 30 });
+		builder.Add(FormDump::Form{ 0x00013982, builder.String("IronSword"), builder.Ids(kIronKeywords), 9.0f, 25, 41 });
+		builder.Add(FormDump::Vendor{ 0x0001A67B, builder.String("Belethor"), builder.Ids(kBelethorFactions), builder.Ids(kBelethorChests) });
+		builder.Add(FormDump::Vendor{ 0x00013478, builder.String("Adrianne"), {}, {} });
+		CHECK(builder.Forms() == 3);
+		CHECK(builder.Vendors() == 2);
+		REQUIRE(builder.Write(path));
+		return ReadAll(path);
+	}
+}
+
+TEST_CASE("A form dump reads back what was built", "[formdump]") {
+	const auto path = TempPath("formdump_roundtrip.bin");
+	const auto bytes = SampleFile(path);
+	const auto view = bytes.Map();
+	REQUIRE(view.Valid());
+
+	// Both tables are sorted by FormID, whatever order the records were added in
+	REQUIRE(view.Forms().size() == 3);
+	REQUIRE(view.Vendors().size() == 2);
+	CHECK(std::ranges::is_sorted(view.Forms(), {}, &FormDump::Form::formID));
+	CHECK(std::ranges::is_sorted(view.Vendors(), {}, &FormDump::Vendor::formID));
+
+	const auto* sword = view.FindForm(0x00013982);
+	REQUIRE(sword);
+	CHECK(view.String(sword->editorID) == "IronSword");
+	CHECK(sword->weight == 9.0f);
+	CHECK(sword->value == 25);
+	CHECK(sword->type == 41);
+	const auto* ingot = view.FindForm(0x0003EADE);
+	REQUIRE(ingot);
+	CHECK(ingot->editorID == FormDump::kNoString);
+	CHECK(view.Ids(ingot->keywords).empty());
+
+	const auto* belethor = view.FindVendor(0x0001A67B);
+	REQUIRE(belethor);
+	CHECK(view.String(belethor->editorID) == "Belethor");
+	REQUIRE(view.FindVendor(0x00013478));
+	CHECK(view.String(view.FindVendor(0x00013478)->editorID) == "Adrianne");
+
+	// Misses on either side of the table and between its records
+	CHECK_FALSE(view.FindForm(0x00000001));
+	CHECK_FALSE(view.FindForm(0x00013000));
+	CHECK_FALSE(view.FindForm(0xFFFFFFFF));
+	CHECK_FALSE(view.FindVendor(0x00012EB7));
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("Form dump lists and editor IDs come from their pools", "[formdump]") {
+	const auto path = TempPath("formdump_pools.bin");
+	const auto bytes = SampleFile(path);
+	const auto view = bytes.Map();
+	REQUIRE(view.Valid());
+
+	// Two forms share the keyword list's values, each in its own range of the pool
+	const auto dagger = view.Ids(view.FindForm(0x00012EB7)->keywords);
+	const auto sword = view.Ids(view.FindForm(0x00013982)->keywords);
+	CHECK(std::ranges::equal(dagger, kIronKeywords));
+	CHECK(std::ranges::equal(sword, kIronKeywords));
+	CHECK(dagger.data() != sword.data());
+
+	const auto* belethor = view.FindVendor(0x0001A67B);
+	CHECK(std::ranges::equal(view.Ids(belethor->factions), kBelethorFactions));
+	CHECK(std::ranges::equal(view.Ids(belethor->containers), kBelethorChests));
+	CHECK(view.Ids(view.FindVendor(0x00013478)->factions).empty());
+
+	// Every editor ID ends at its own NUL, and offsets outside the table read as empty
+	CHECK(view.String(view.FindForm(0x00012EB7)->editorID) == "IronDagger");
+	CHECK(view.String(FormDump::kNoString).empty());
+	CHECK(view.String(1'000'000).empty());
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("A form dump view rejects files it cannot use in place", "[formdump]") {
+	const auto path = TempPath("formdump_corrupt.bin");
+	auto bytes = SampleFile(path);
+	REQUIRE(bytes.Map().Valid());
+
+	SECTION("truncated inside the header") {
+		bytes.size = sizeof(FormDump::Header) - 1;
+		CHECK_FALSE(bytes.Map().Valid());
+	}
+	SECTION("truncated inside the string table") {
+		bytes.size -= 3;
+		CHECK_FALSE(bytes.Map().Valid());
+	}
+	SECTION("foreign magic or another version") {
+		bytes.data()[0] = 'X';
+		CHECK_FALSE(bytes.Map().Valid());
+		bytes.data()[0] = FormDump::kMagic[0];
+		bytes.Header().version = FormDump::kVersion + 1;
+		CHECK_FALSE(bytes.Map().Valid());
+	}
+	SECTION("misaligned table offset") {
+		bytes.Header().vendorsOffset += 4;
+		CHECK_FALSE(bytes.Map().Valid());
+	}
+	SECTION("table offset past the end of the file") {
+		bytes.Header().idsOffset = (bytes.size + 8) & ~size_t{ 7 };
+		CHECK_FALSE(bytes.Map().Valid());
+	}
+	SECTION("table count running past the end of the file") {
+		bytes.Header().formCount = 0x10000000u;
+		CHECK_FALSE(bytes.Map().Valid());
+	}
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("An out-of-range id list reads as empty", "[formdump]") {
+	const auto path = TempPath("formdump_range.bin");
+	const auto bytes = SampleFile(path);
+	const auto view = bytes.Map();
+	REQUIRE(view.Valid());
+	const auto pool = static_cast<std::uint32_t>(kIronKeywords.size() * 2 + kBelethorFactions.size() + kBelethorChests.size());
+
+	CHECK(view.Ids({ 0, pool }).size() == pool);
+	CHECK(view.Ids({ pool, 0 }).empty());
+	CHECK(view.Ids({ pool + 1, 0 }).empty());
+	CHECK(view.Ids({ 0, pool + 1 }).empty());
+	CHECK(view.Ids({ pool - 1, 2 }).empty());
+	// A count that wraps begin + count around must not pass for in range
+	CHECK(view.Ids({ 2, UINT32_MAX }).empty());
+	std::filesystem::remove(path);
+}
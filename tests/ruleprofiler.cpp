@@ -0,0 +1,163 @@
+#include "comparisonfilter.h"
+#include "ruleprofiler.h"
+#include "settings.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+	// Stand-in for one config entry as the reference evaluator runs it: any of its item filters
+	// (weight, value, keyword) and all of its player filters (level) must pass
+	struct Entry {
+		struct Item {
+			ComparisonFilter weight;
+			ComparisonFilter value;
+			std::uint32_t keyword;
+		};
+		std::vector<Item> items;
+		ComparisonFilter level;
+	};
+
+	struct Stack {
+		float weight;
+		float value;
+		std::uint64_t keywords;
+	};
+
+	ComparisonFilter Filter(ComparisonFilter::ComparisonType type, float value) {
+		ComparisonFilter filter;
+		filter.type = type;
+		filter.value = value;
+		return filter;
+	}
+
+	std::vector<Entry> MakeSection(size_t count, std::mt19937& rng) {
+		std::uniform_real_distribution<float> weight(0.0f, 30.0f), value(0.0f, 2000.0f);
+		std::uniform_int_distribution<std::uint32_t> keyword(0, 63);
+		std::vector<Entry> section(count);
+		for (auto& entry : section) {
+			for (int n = 0; n < 3; ++n) {
+				entry.items.push_back({ Filter(ComparisonFilter::LESS, weight(rng)), Filter(ComparisonFilter::GREATER_EQUAL, value(rng)), keyword(rng) });
+			}
+			entry.level = Filter(ComparisonFilter::GREATER_EQUAL, 10.0f);
+		}
+		return section;
+	}
+
+	bool Matches(const Entry& entry, const Stack& stack, float level) {
+		if (!entry.level.Matches(level)) return false;
+		return std::any_of(entry.items.begin(), entry.items.end(), [&](const Entry::Item& item) {
+			return item.weight.Matches(stack.weight) && item.value.Matches(stack.value) && ((stack.keywords >> item.keyword) & 1);
+		});
+	}
+
+	// The production call shape of MatchEntries on an interpreted section, returns the matches seen
+	std::uint64_t RunCalls(RuleProfiler& profiler, const std::vector<Entry>& section, const std::vector<size_t>& entries,
+		const std::vector<Stack>& stacks, float level) {
+		std::uint64_t matches = 0;
+		for (const auto& stack : stacks) {
+			const bool timeCall = profiler.SampleCall(0);
+			const std::uint64_t callStart = timeCall ? __rdtsc() : 0;
+			const bool rulesDue = profiler.RulesDue(entries.size());
+			profiler.Evaluate(0, entries, rulesDue, [&](size_t i) { return Matches(section[i], stack, level); }, [&](size_t) { ++matches; });
+			if (timeCall) profiler.RecordCall(0, __rdtsc() - callStart);
+			if (rulesDue && profiler.HasFindings()) {
+				profiler.TakeFlagged();
+				profiler.TakeSuspects();
+			}
+		}
+		return matches;
+	}
+}
+
+TEST_CASE("Sampling times about one rule evaluation in ruleEvery", "[ruleprofiler]") {
+	RuleProfiler profiler;
+	profiler.Configure(64, 8, 1e9, { 100, 0, 0 });
+	std::vector<size_t> entries(100);
+	std::iota(entries.begin(), entries.end(), 0);
+	for (int call = 0; call < 10'000; ++call) {
+		const bool timeCall = profiler.SampleCall(0);
+		if (timeCall) profiler.RecordCall(0, 1);
+		profiler.Evaluate(0, entries, profiler.RulesDue(entries.size()), [](size_t) { return true; }, [](size_t) {});
+	}
+	std::uint64_t samples = 0;
+	for (const auto& rule : profiler.Rules(0)) samples += rule.samples;
+	const double expected = 10'000.0 * 100 / 64;
+	CHECK(samples > expected * 0.9);
+	CHECK(samples < expected * 1.1);
+	CHECK(profiler.CallStats(0).calls == 10'000);
+	CHECK(profiler.CallStats(0).samples == 10'000 / 8);
+	// Every rule gets sampled, whatever its position in the section
+	for (const auto& rule : profiler.Rules(0)) CHECK(rule.samples > 0);
+}
+
+TEST_CASE("A disabled profiler never samples", "[ruleprofiler]") {
+	RuleProfiler profiler;
+	profiler.Configure(0, 0, 1e9, { 10, 0, 0 });
+	std::vector<size_t> entries(10);
+	std::iota(entries.begin(), entries.end(), 0);
+	for (int call = 0; call < 1'000; ++call) {
+		CHECK_FALSE(profiler.SampleCall(0));
+		CHECK_FALSE(profiler.RulesDue(entries.size()));
+	}
+	for (const auto& rule : profiler.Rules(0)) CHECK(rule.samples == 0);
+}
+
+// The overhead bound of the sampling profiler on the interpreted MatchEntries path: the default rates
+// against sampling off, same sections and stacks. The stacks run in short chunks, alternating sides; each
+// side keeps its fastest run of every chunk, so preemption and frequency changes on a shared machine drop
+// out instead of landing on one side. A measurement over the bound is retried twice, since noise only
+// ever adds time to one side.
+TEST_CASE("Sampling overhead stays under 1% at the default rates", "[ruleprofiler][benchmark]") {
+	const EngineSettings defaults;
+	std::mt19937 rng(47);
+	std::uniform_real_distribution<float> weight(0.0f, 30.0f), value(0.0f, 2000.0f);
+	constexpr size_t kChunks = 40, kChunkStacks = 64, kRuns = 25;
+	std::vector<std::vector<Stack>> chunks(kChunks, std::vector<Stack>(kChunkStacks));
+	for (auto& chunk : chunks) {
+		for (auto& stack : chunk) stack = { weight(rng), value(rng), (std::uint64_t{ rng() } << 32) | rng() };
+	}
+
+	for (size_t count : { size_t{ 16 }, size_t{ 64 }, size_t{ 256 } }) {
+		const auto section = MakeSection(count, rng);
+		std::vector<size_t> entries(count);
+		std::iota(entries.begin(), entries.end(), 0);
+
+		RuleProfiler on, off;
+		on.Configure(defaults.profileRuleEvery, defaults.profileCallEvery, 1e9, { count, 0, 0 });
+		off.Configure(0, 0, 1e9, { count, 0, 0 });
+
+		std::uint64_t matchesOn = 0, matchesOff = 0;
+		auto time = [&](RuleProfiler& profiler, const std::vector<Stack>& chunk, std::uint64_t& matches) {
+			const auto start = std::chrono::steady_clock::now();
+			matches += RunCalls(profiler, section, entries, chunk, 20.0f);
+			return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		};
+		double overhead = 1e300;
+		for (int attempt = 0; attempt < 3 && overhead >= 1.0; ++attempt) {
+			double totalOn = 0.0, totalOff = 0.0;
+			for (const auto& chunk : chunks) {
+				double bestOn = 1e300, bestOff = 1e300;
+				for (size_t run = 0; run < kRuns; ++run) {
+					bestOff = std::min(bestOff, time(off, chunk, matchesOff));
+					bestOn = std::min(bestOn, time(on, chunk, matchesOn));
+				}
+				totalOn += bestOn;
+				totalOff += bestOff;
+			}
+			const double calls = static_cast<double>(kChunks * kChunkStacks);
+			overhead = std::min(overhead, 100.0 * (totalOn - totalOff) / totalOff);
+			std::printf("RuleProfiler overhead, %zu entries, 1 in %u rules and %u calls: %+.2f%% (%.1f ns sampled, %.1f ns unsampled per call)\n",
+				count, defaults.profileRuleEvery, defaults.profileCallEvery, 100.0 * (totalOn - totalOff) / totalOff, totalOn / calls, totalOff / calls);
+		}
+		CHECK(matchesOn == matchesOff);
+		CHECK(overhead < 1.0);
+	}
+}
@@ -0,0 +1,89 @@
+#include "threadpool.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("ParallelFor visits every index once", "[threadpool]") {
+	ThreadPool pool(4);
+	std::vector<std::atomic<int>> visits(100'000);
+	pool.ParallelFor(0, visits.size(), 64, [&](size_t i) { visits[i].fetch_add(1, std::memory_order_relaxed); });
+	for (const auto& v : visits) REQUIRE(v.load() == 1);
+}
+
+TEST_CASE("A throwing task still finishes its group and Wait rethrows", "[threadpool]") {
+	ThreadPool pool(4);
+	ThreadPool::Group group;
+	std::atomic<int> ran = 0;
+	for (int i = 0; i < 100; ++i) {
+		pool.Submit(group, ThreadPool::Priority::Normal, [&ran, i]() {
+			ran.fetch_add(1, std::memory_order_relaxed);
+			if (i % 10 == 3) throw std::runtime_error("task failed");
+		});
+	}
+	CHECK_THROWS_AS(group.Wait(pool), std::runtime_error);
+	CHECK(group.Done());
+	CHECK(ran.load() == 100);
+
+	// The exception is reported once, and the pool keeps working
+	CHECK_NOTHROW(group.Wait(pool));
+	int sum = 0;
+	std::atomic<int> total = 0;
+	pool.ParallelFor(0, 1000, 10, [&](size_t i) { total.fetch_add(static_cast<int>(i), std::memory_order_relaxed); });
+	for (int i = 0; i < 1000; ++i) sum += i;
+	CHECK(total.load() == sum);
+}
+
+TEST_CASE("ParallelFor rethrows an exception of its callable", "[threadpool]") {
+	ThreadPool pool(3);
+	std::atomic<size_t> ran = 0;
+	CHECK_THROWS_WITH(pool.ParallelFor(0, 10'000, 16, [&](size_t i) {
+		ran.fetch_add(1, std::memory_order_relaxed);
+		if (i == 5'000) throw std::runtime_error("index 5000");
+	}), "index 5000");
+	// Every other chunk still ran; the failing chunk (4992..5007) stopped after its throwing index
+	CHECK(ran.load() == 10'000 - 7);
+}
+
+TEST_CASE("Throwing tasks run inline on a full ring finish their group", "[threadpool]") {
+	// One worker and far more tasks than its ring holds, so most run on the submitting thread
+	ThreadPool pool(1);
+	ThreadPool::Group group;
+	std::atomic<int> ran = 0;
+	const int tasks = static_cast<int>(ThreadPool::kSlots) * 20;
+	for (int i = 0; i < tasks; ++i) {
+		pool.Submit(group, ThreadPool::Priority::Low, [&ran, i]() {
+			ran.fetch_add(1, std::memory_order_relaxed);
+			if (i % 7 == 0) throw std::logic_error("task failed");
+		});
+	}
+	CHECK_THROWS_AS(group.Wait(pool), std::logic_error);
+	CHECK(ran.load() == tasks);
+}
+
+TEST_CASE("Stress: nested groups with throwing tasks never hang", "[threadpool]") {
+	ThreadPool pool(4);
+	for (int round = 0; round < 50; ++round) {
+		std::atomic<int> failures = 0;
+		std::atomic<int> ran = 0;
+		// Outer tasks wait on inner groups from the workers, so Wait runs other groups' throwing tasks too
+		pool.ParallelFor(0, 32, 1, [&](size_t outer) {
+			ThreadPool::Group inner;
+			for (int i = 0; i < 64; ++i) {
+				pool.Submit(inner, static_cast<ThreadPool::Priority>(i % ThreadPool::kPriorities), [&ran, outer, i]() {
+					ran.fetch_add(1, std::memory_order_relaxed);
+					if ((outer + i) % 5 == 0) throw std::runtime_error("inner");
+				});
+			}
+			try {
+				inner.Wait(pool);
+			} catch (const std::runtime_error&) {
+				failures.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+		REQUIRE(ran.load() == 32 * 64);
+		REQUIRE(failures.load() == 32);
+	}
+}